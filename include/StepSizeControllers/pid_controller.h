@@ -0,0 +1,59 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDDDST_CORE_PID_CONTROLLER_H
+#define SDDDST_CORE_PID_CONTROLLER_H
+
+#include "StepSizeControllers/step_size_controller.h"
+
+namespace sdddstCore {
+
+/**
+ * @brief The PIDController class uses the error ratios of the previous accepted steps as well
+ * (Gustafsson's PI controller if the derivative gain is zero). After a rejection the step size is not
+ * increased in the next accepted step.
+ */
+class PIDController : public StepSizeController
+{
+public:
+    PIDController(double integralGain, double proportionalGain, double derivativeGain);
+    virtual ~PIDController();
+
+    virtual double getNewStepSize(double oldStepSize, double errorRatioSqr, bool accepted);
+    virtual void reset();
+    virtual std::string getType();
+    virtual void writeCheckpoint(CheckpointWriter & writer) const;
+    virtual void readCheckpoint(CheckpointReader & reader);
+
+protected:
+    double kI;
+    double kP;
+    double kD;
+
+    // Error ratios of the last two accepted steps, zero if there is no such step yet
+    double lastErrorRatio;
+    double secondLastErrorRatio;
+
+    // True if the last attempt was rejected
+    bool lastRejected;
+};
+
+}
+
+#endif
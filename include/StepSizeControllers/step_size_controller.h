@@ -0,0 +1,87 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDDDST_CORE_STEP_SIZE_CONTROLLER_H
+#define SDDDST_CORE_STEP_SIZE_CONTROLLER_H
+
+#include "checkpoint.h"
+
+#include <memory>
+#include <string>
+
+namespace sdddstCore {
+
+/**
+ * @brief The StepSizeController class is the base class for all step size controllers. It is the elementary
+ * controller as well: the new step size depends only on the error of the current attempt
+ * (safety factor 0.9, the error ratio on the power of -1/errorOrder, at most doubling)
+ */
+class StepSizeController
+{
+public:
+    StepSizeController();
+    virtual ~StepSizeController();
+
+    /**
+     * @brief getNewStepSize calculates the step size of the next attempt
+     * @param oldStepSize the step size of the current attempt
+     * @param errorRatioSqr the largest squared ratio of the error and the tolerance in the current attempt
+     * @param accepted true if the current attempt was accepted
+     * @return the new step size
+     */
+    virtual double getNewStepSize(double oldStepSize, double errorRatioSqr, bool accepted);
+
+    /**
+     * @brief reset forgets the history of the previous steps
+     */
+    virtual void reset();
+
+    /**
+     * @brief getType
+     * @return returns with the type of the controller
+     */
+    virtual std::string getType();
+
+    /**
+     * @brief writeCheckpoint saves the history of the previous steps
+     * @param writer
+     */
+    virtual void writeCheckpoint(CheckpointWriter & writer) const;
+
+    /**
+     * @brief readCheckpoint restores the history saved by writeCheckpoint
+     * @param reader
+     */
+    virtual void readCheckpoint(CheckpointReader & reader);
+
+    /**
+     * @brief setErrorOrder sets the power of the step size in the error estimate of the integrator
+     * @param value
+     */
+    void setErrorOrder(double value);
+    double getErrorOrder() const;
+
+protected:
+    // The error estimate is proportional to the step size on this power
+    double errorOrder;
+};
+
+}
+
+#endif
@@ -35,11 +35,17 @@ public:
     virtual double getStressDerivative(double simulationTime);
 
     virtual std::string getType();
+    virtual std::unique_ptr<StressProtocol> clone() const;
+    virtual void copyState(const StressProtocol & other);
+    virtual void writeCheckpoint(CheckpointWriter & writer) const;
+    virtual void readCheckpoint(CheckpointReader & reader);
 
     double getRate() const;
     void setRate(double value);
 
 protected:
+    void copyStressValues(const FixedRateProtocol & other);
+
     double rate;
     double * stressValues;
 };
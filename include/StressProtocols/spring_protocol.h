@@ -34,6 +34,7 @@ public:
     virtual void calculateStress(double simulationTime, const std::vector<Dislocation> &dislocations, StressProtocolStepType type, double strain);
 
     virtual std::string getType();
+    virtual std::unique_ptr<StressProtocol> clone() const;
 
     double getSpringConstant() const;
     void setSpringConstant(double newSpringConstant);
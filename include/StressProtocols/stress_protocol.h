@@ -20,6 +20,7 @@
 #ifndef SDDDST_CORE_STRESS_PROTOCOL_H
 #define SDDDST_CORE_STRESS_PROTOCOL_H
 
+#include "checkpoint.h"
 #include "dislocation.h"
 
 #include <memory>
@@ -79,6 +80,30 @@ public:
      * @return returns with the type of the applied stress field
      */
     virtual std::string getType();
+
+    /**
+     * @brief clone creates an independent copy of the protocol with the same parameters and stress values
+     * @return the new protocol
+     */
+    virtual std::unique_ptr<StressProtocol> clone() const;
+
+    /**
+     * @brief copyState copies the stress values of another protocol of the same type (created by clone) without allocation
+     * @param other
+     */
+    virtual void copyState(const StressProtocol & other);
+
+    /**
+     * @brief writeCheckpoint saves the state of the protocol which is needed to continue the simulation
+     * @param writer
+     */
+    virtual void writeCheckpoint(CheckpointWriter & writer) const;
+
+    /**
+     * @brief readCheckpoint restores the state saved by writeCheckpoint
+     * @param reader
+     */
+    virtual void readCheckpoint(CheckpointReader & reader);
 };
 
 }
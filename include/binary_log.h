@@ -0,0 +1,118 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDDDST_CORE_BINARY_LOG_H
+#define SDDDST_CORE_BINARY_LOG_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sdddstCore {
+
+/**
+ * A binary log file starts with a header: the magic number, the version, the number of columns and the
+ * names of the columns (zero padded to a fixed length). It is followed by the rows, every row contains
+ * one double for every column, the missing values are NaN.
+ */
+struct BinaryLogHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t columns;
+};
+
+/**
+ * @brief BinaryLog collects the rows in a large buffer which is written by a background thread
+ * while the next buffer is filled
+ */
+class BinaryLog
+{
+public:
+    /// If append is true and the file is not empty, the rows are added after the existing ones with the same columns
+    BinaryLog(const std::string & path, bool append = false);
+    ~BinaryLog();
+
+    BinaryLog(const BinaryLog &) = delete;
+    BinaryLog & operator=(const BinaryLog &) = delete;
+
+    /// Writes the header, it has to be called once before the first row
+    void setColumns(const std::vector<std::string> & names);
+    size_t getColumnCount() const;
+
+    /// Adds a row with as many values as columns
+    void addRow(const double * values);
+
+    /// Writes every collected row
+    void flush();
+
+    /// Writes every collected row and returns with the size of the file
+    int64_t getSize();
+
+private:
+    void start();
+    void handOver();
+    void work();
+
+    std::string path;
+    std::ofstream out;
+    size_t columns;
+
+    std::vector<double> filling;
+    std::vector<double> writing;
+    bool pending;
+    bool stop;
+
+    std::mutex mutex;
+    std::condition_variable handedOver;
+    std::condition_variable written;
+    std::thread writer;
+};
+
+/**
+ * @brief BinaryLogReader reads the columns of a binary log, the rows appended since are read as well
+ */
+class BinaryLogReader
+{
+public:
+    BinaryLogReader(const std::string & path);
+
+    std::vector<std::string> getColumnNames() const;
+    size_t getRowCount();
+
+    /// The values of the column with the given index
+    std::vector<double> getColumn(size_t column);
+
+    /// The values of the column with the given name
+    std::vector<double> getColumnByName(const std::string & name);
+
+private:
+    std::string path;
+    std::ifstream in;
+    std::vector<std::string> names;
+    uint64_t headerSize;
+};
+
+}
+
+#endif
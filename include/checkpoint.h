@@ -0,0 +1,130 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDDDST_CORE_CHECKPOINT_H
+#define SDDDST_CORE_CHECKPOINT_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace sdddstCore {
+
+/**
+ * @brief CheckpointWriter writes the state of a simulation as binary values. The file is written next to the
+ * final path and renamed at the end, so an interrupted write does not destroy the previous checkpoint.
+ */
+class CheckpointWriter
+{
+public:
+    CheckpointWriter(const std::string & path);
+
+    template<typename T>
+    void write(const T & value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written directly");
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    void write(const std::vector<T> & values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written directly");
+        write(uint64_t(values.size()));
+        out.write(reinterpret_cast<const char*>(values.data()), std::streamsize(values.size() * sizeof(T)));
+    }
+
+    void write(const std::string & value);
+
+    /// Closes the file and replaces the previous checkpoint with it
+    void commit();
+
+private:
+    std::string path;
+    std::string temporaryPath;
+    std::ofstream out;
+};
+
+/**
+ * @brief CheckpointReader reads the values in the order they were written, the program is stopped if the
+ * file is invalid
+ */
+class CheckpointReader
+{
+public:
+    CheckpointReader(const std::string & path);
+
+    template<typename T>
+    void read(T & value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be read directly");
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+        check();
+    }
+
+    template<typename T>
+    void read(std::vector<T> & values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be read directly");
+        uint64_t size;
+        read(size);
+        values.resize(size);
+        in.read(reinterpret_cast<char*>(values.data()), std::streamsize(size * sizeof(T)));
+        check();
+    }
+
+    void read(std::string & value);
+
+    /// Reads a string and stops the program if it is not the expected one (types of the components)
+    void expect(const std::string & value);
+
+private:
+    void check();
+
+    std::string path;
+    std::ifstream in;
+};
+
+/**
+ * @brief getOutputFileSize
+ * @return the size of the file or -1 if it does not exist
+ */
+int64_t getOutputFileSize(const std::string & path);
+
+/**
+ * @brief truncateOutputFile drops the output written after a checkpoint, the file is emptied if the size is negative
+ */
+void truncateOutputFile(const std::string & path, int64_t size);
+
+/**
+ * @brief installCheckpointSignalHandler makes SIGTERM request a checkpoint instead of stopping the program
+ */
+void installCheckpointSignalHandler();
+
+/**
+ * @brief isCheckpointSignalReceived
+ * @return true if SIGTERM was received since the handler is installed
+ */
+bool isCheckpointSignalReceived();
+
+}
+
+#endif
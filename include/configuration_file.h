@@ -0,0 +1,91 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDDDST_CORE_CONFIGURATION_FILE_H
+#define SDDDST_CORE_CONFIGURATION_FILE_H
+
+#include "dislocation.h"
+#include "point_defect.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sdddstCore {
+
+/**
+ * Binary configuration files start with a fixed size header, followed by one
+ * column of doubles per coordinate (x, y and for dislocations b). The header is
+ * a multiple of 8 bytes long, so every column is aligned and can be used
+ * directly from the mapped memory. The numbers are stored in the byte order of
+ * the writing machine.
+ */
+enum ConfigurationKind
+{
+    DislocationConfiguration = 0,
+    PointDefectConfiguration = 1
+};
+
+struct ConfigurationFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t kind;
+    uint64_t count;
+    uint64_t columns;
+};
+
+/**
+ * @brief isBinaryConfigurationFile checks the magic number at the beginning of the file
+ * @param path of the file
+ * @return true if the file is a regular file in the binary configuration format
+ */
+bool isBinaryConfigurationFile(const std::string & path);
+
+/**
+ * @brief MappedConfigurationFile maps a binary configuration file read only into the memory,
+ * the columns point into the mapping and are valid while the object lives
+ */
+class MappedConfigurationFile
+{
+public:
+    MappedConfigurationFile(const std::string & path, ConfigurationKind kind);
+    ~MappedConfigurationFile();
+
+    MappedConfigurationFile(const MappedConfigurationFile &) = delete;
+    MappedConfigurationFile & operator=(const MappedConfigurationFile &) = delete;
+
+    uint64_t getCount() const;
+
+    /// The i-th column: 0 is x, 1 is y, 2 is b
+    const double * getColumn(unsigned int i) const;
+
+private:
+    void * mapping;
+    size_t mappingSize;
+    const ConfigurationFileHeader * header;
+};
+
+/// Writers of the binary format
+void writeBinaryDislocationFile(const std::string & path, const std::vector<Dislocation> & dislocations);
+void writeBinaryPointDefectFile(const std::string & path, const std::vector<PointDefect> & points);
+
+}
+
+#endif
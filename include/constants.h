@@ -27,6 +27,68 @@
 #define DEFAULT_CUTOFF 1.0
 #define DEFAULT_PRECISION 1e-8
 #define DEFAULT_ITERATION_COUNT 2
+#define DEFAULT_MIN_ITERATION_COUNT 1
+#define DEFAULT_MAX_ITERATION_COUNT 10
+#define DEFAULT_MULTIRATE_MAX_FAST_RATIO 0.1
+#define DEFAULT_MULTIRATE_MAX_SUBSTEPS 16
+
+// Local extrapolation of the step doubling: the error of the trapezoidal rule is proportional to the third power of the step size,
+// so the error of the two half steps is a third of their difference from the big step
+#define RICHARDSON_ERROR_DIVISOR 3.0
+// The damping blends the rule toward the first order backward Euler, where the divisor would be 1. Above this damping
+// (the stiffness times the step size is about 0.03) the first order part of the error is not negligible, so these
+// dislocations are not extrapolated and their error is the whole difference
+#define RICHARDSON_MAX_DAMPING 1e-3
+// The local error estimates of the integrators are proportional to the third power of the step size
+#define DEFAULT_ERROR_ESTIMATE_ORDER 3.0
+// Gains of the PI(D) step size controllers (Gustafsson)
+#define CONTROLLER_INTEGRAL_GAIN 0.3
+#define CONTROLLER_PROPORTIONAL_GAIN 0.4
+#define CONTROLLER_DERIVATIVE_GAIN 0.1
+// Parameters of the FIRE relaxation (Bitzek et al.)
+#define FIRE_N_MIN 5
+#define FIRE_TIME_STEP_INCREASE 1.1
+#define FIRE_TIME_STEP_DECREASE 0.5
+#define FIRE_ALPHA_START 0.1
+#define FIRE_ALPHA_DECREASE 0.99
+#define FIRE_INITIAL_TIME_STEP 0.1
+#define FIRE_MAX_TIME_STEP 1.0
+#define FIRE_MAX_DISPLACEMENT 1e-2
+#define FIRE_PAIR_COUPLING_RATIO 0.5
+#define DEFAULT_RELAXATION_FORCE_TOLERANCE 1e-6
+#define DEFAULT_RELAXATION_MAX_ITERATIONS 1000000
+
+// Parameters of the athermal quasistatic loading
+#define DEFAULT_AQS_STRESS_STEP 1e-3
+#define DEFAULT_AQS_AVALANCHE_STRAIN 1e-4
+#define AQS_APPROACH_FRACTION 0.5
+#define AQS_MIN_STRESS_STEP_RATIO 1e-4
+#define AQS_JACOBIAN_STEP_SIZE 1e8
+#define AQS_MAX_NEWTON_ITERATIONS 20
+#define AQS_INVERSE_ITERATIONS 3
+
+// Number of sub-configurations buffered for the background writer
+#define DEFAULT_SUB_CONFIG_QUEUE_SIZE 16
+
+// Binary configuration files
+#define CONFIGURATION_FILE_MAGIC "SDDDSTCF"
+#define CONFIGURATION_FILE_VERSION 1
+
+// Binary log files
+#define BINARY_LOG_MAGIC "SDDDSTLG"
+#define BINARY_LOG_VERSION 1
+#define BINARY_LOG_COLUMN_NAME_LENGTH 32
+#define BINARY_LOG_BUFFER_ROWS 65536
+
+// Checkpoint files
+#define CHECKPOINT_FILE_MAGIC "SDDDSTCP"
+#define CHECKPOINT_FILE_VERSION 1
+
+// Trajectory files
+#define TRAJECTORY_FILE_MAGIC "SDDDSTTR"
+#define TRAJECTORY_FILE_VERSION 1
+#define DEFAULT_TRAJECTORY_CHUNK_SIZE 64
+
 #define DEFAULT_TIME_LIMIT 0.0
 #define DEFAULT_STEP_SIZE 1.0
 #define DEFAULT_SIM_TIME 0.0
@@ -1,20 +1,55 @@
 #ifndef DATATIMESERIES_H
 #define DATATIMESERIES_H
 
-#include <list>
+#include <memory>
 #include <string>
+#include <vector>
 #include "simulation_data.h"
+#include "trajectory.h"
 
 class DataTimeSeries
 {
 public:
+    /**
+     * @param dconfList a file list with (time, dconf path) pairs or a trajectory file
+     * @param fconf the point defect configuration
+     */
     DataTimeSeries(std::string dconfList, std::string fconf = "");
 
+    /**
+     * @brief setTimeRange restricts the series to the frames between the given times (inclusive), the first one is
+     * found with binary search, so the times have to be increasing
+     */
+    void setTimeRange(double startTime, double endTime);
+
+    /**
+     * @brief setStride only every stride-th frame of the range is read
+     */
+    void setStride(size_t stride);
+
     bool next(std::shared_ptr<sdddstCore::SimulationData> sD);
 
+    size_t getFrameCount() const;
+    double getTime(size_t frame) const;
+
 private:
-    std::list<std::pair<double, std::string>> dconfs;
+    /// Moves nextFrame to the next selected frame, false if there is no such frame (yet)
+    bool findNextFrame();
+
+    /// The first frame from the given one with at least the given time
+    size_t findFrame(double time, size_t first) const;
+
+    std::vector<std::pair<double, std::string>> dconfs;
     std::string fconfPath;
+
+    // The frames are read from here if the list is a trajectory file, the ones appended later are read as well
+    std::unique_ptr<sdddstCore::TrajectoryReader> trajectory;
+    size_t nextFrame;
+
+    // The selected frames: every stride-th frame from the first one after startTime until endTime
+    double startTime;
+    double endTime;
+    size_t stride;
 };
 
 #endif // DATATIMESERIES_H
@@ -0,0 +1,54 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDDDST_CORE_INPUT_STREAM_H
+#define SDDDST_CORE_INPUT_STREAM_H
+
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <fstream>
+#include <string>
+
+namespace sdddstCore {
+
+/**
+ * @brief InputStream opens a text input which can be compressed with gzip or zstd, the compression is recognised
+ * from the first bytes. The path "-" means the standard input. The input is read only once from the beginning to
+ * the end, so pipes can be used as well.
+ */
+class InputStream
+{
+public:
+    InputStream(const std::string & path);
+
+    InputStream(const InputStream &) = delete;
+    InputStream & operator=(const InputStream &) = delete;
+
+    /// The decompressed text
+    std::istream & get();
+
+private:
+    // The file is declared first, so it is still open while the decompressor is closed
+    std::ifstream file;
+    boost::iostreams::filtering_istream stream;
+};
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDDDST_CORE_INTEGRATOR_WORKSPACE_H
+#define SDDDST_CORE_INTEGRATOR_WORKSPACE_H
+
+#include "precision_handler.h"
+
+#include <vector>
+
+namespace sdddstCore {
+
+/**
+ * @brief The IntegratorWorkspace struct contains every buffer which is written during one implicit
+ * integration, so independent integrations can be run at the same time with separate workspaces
+ */
+struct IntegratorWorkspace
+{
+    IntegratorWorkspace();
+    ~IntegratorWorkspace();
+
+    IntegratorWorkspace(const IntegratorWorkspace &) = delete;
+    IntegratorWorkspace & operator=(const IntegratorWorkspace &) = delete;
+
+    /**
+     * @brief resize reallocates the buffers for the given dislocation count
+     * @param dc dislocation count
+     */
+    void resize(unsigned int dc);
+
+    /**
+     * @brief shrink reduces the sizes to a smaller dislocation count, the buffers are kept
+     * @param dc dislocation count
+     */
+    void shrink(unsigned int dc);
+
+    /**
+     * @brief release frees every allocated buffer
+     */
+    void release();
+
+    // the g vector from the calculations
+    std::vector<double> g;
+    // Stores speed during the NR iteration
+    std::vector<double> speed;
+    // Stores the d values for the integration scheme
+    std::vector<double> dVec;
+    // Stage values of the Rosenbrock-W method
+    std::vector<std::vector<double> > stages;
+
+    // UMFPack specified sparse format stored Jacobian
+    int * Ap;
+    int * Ai;
+    double * Ax;
+    // Result data
+    double * x;
+
+    // UMFPack required variables
+    double *null;
+    void *Symbolic, *Numeric;
+
+    // Diagonal indexes in the Jacobian
+    std::vector<int> indexes;
+
+    // The number of elements which can be stored in Ax
+    unsigned currentStorageSize;
+
+    // Collects the tolerances found during the integration, merged into the main handler before the error check
+    PrecisionHandler tolerance;
+
+    // Number of the NR iterations done with this workspace since the last reset
+    unsigned int iterationCount;
+
+    // True if the NR iteration did not converge during an integration since the last reset
+    bool newtonFailed;
+
+    // Inputs of the last external stress evaluation of the current integration, it is only repeated if they change
+    bool stressIsValid;
+    double stressTime;
+    double stressStrain;
+};
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDDDST_CORE_LOG_AGGREGATOR_H
+#define SDDDST_CORE_LOG_AGGREGATOR_H
+
+#include "checkpoint.h"
+
+#include <string>
+#include <vector>
+
+namespace sdddstCore {
+
+/**
+ * @brief LogAggregator selects the log rows of the successful steps to be written. It writes only every N-th step,
+ * or the minimum, mean and maximum of the columns in windows of the given simulation time. With fullDuringAvalanche
+ * every step of the avalanches is written (as a window of one step in time window mode), if there is no other
+ * selection only the avalanches are logged. The avalanches are detected here from the average speed, independently
+ * of the avalanche counting of the simulation.
+ */
+class LogAggregator
+{
+public:
+    LogAggregator(unsigned int stepInterval, double timeWindow, bool fullDuringAvalanche, double avalancheSpeedThreshold);
+
+    /// The number of the columns of the rows added
+    void setColumnCount(size_t columns);
+
+    /// True if the written rows are the min, mean and max of every column (three times as many columns)
+    bool isWindowed() const;
+
+    /// The number of the written columns
+    size_t getOutputColumnCount() const;
+
+    /// The names of the written columns from the names of the original ones
+    std::vector<std::string> getColumnNames(const std::vector<std::string> & names) const;
+
+    /**
+     * @brief addInitialRow the initial state is always written
+     * @return the row to write
+     */
+    const double * addInitialRow(const double * row);
+
+    /**
+     * @brief addStep collects the row of a successful step
+     * @param row of the step
+     * @param step the number of the successful steps
+     * @param time the simulation time after the step
+     * @param averageSpeed of the dislocations in the step, an avalanche lasts while it is above the threshold
+     * @return the row to write or nullptr if nothing has to be written now
+     */
+    const double * addStep(const double * row, size_t step, double time, double averageSpeed);
+
+    /**
+     * @brief finish closes the unfinished window at the end of the simulation
+     * @return the window or nullptr if there is nothing to write
+     */
+    const double * finish();
+
+    /// Saves and restores the unfinished window and the avalanche state
+    void writeCheckpoint(CheckpointWriter & writer) const;
+    void readCheckpoint(CheckpointReader & reader);
+
+private:
+    void resetWindow();
+    void addToWindow(const double * row);
+    const double * closeWindow();
+
+    unsigned int stepInterval;
+    double timeWindow;
+    bool fullDuringAvalanche;
+    double avalancheSpeedThreshold;
+    bool inAvalanche;
+    size_t columns;
+
+    // The min, mean and max of the rows of the window (the mean is their sum until the window is closed)
+    std::vector<double> window;
+    size_t windowRows;
+    double windowEnd;
+
+    // The window returned by closeWindow
+    std::vector<double> output;
+};
+
+}
+
+#endif
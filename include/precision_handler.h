@@ -39,6 +39,13 @@ public:
 
     void updateError(const double & error, const unsigned int &ID);
 
+    /**
+     * @brief mergeTolerance keeps the stricter tolerance for every dislocation from the two handlers
+     * @param other handler which collected tolerances independently (e.g. on another thread)
+     */
+    void mergeTolerance(const PrecisionHandler & other);
+
+    /// The step size suggested by the elementary step size controller for the current error
     double getNewStepSize(const double & oldStepSize) const;
 
     double getMinPrecisity() const;
@@ -46,6 +53,25 @@ public:
 
     double getMaxErrorRatioSqr() const;
 
+    /**
+     * @brief getErrorRatioSqr gives the squared ratio of the error and the tolerance of one dislocation
+     * @param ID the ID of the dislocation
+     */
+    double getErrorRatioSqr(const unsigned int & ID) const;
+
+    /**
+     * @brief getToleranceSqr gives the squared tolerance of one dislocation
+     * @param ID the ID of the dislocation
+     */
+    double getToleranceSqr(const unsigned int & ID) const;
+
+    /**
+     * @brief clearError removes the error of one dislocation (e.g. when it was integrated separately)
+     * and updates the maximal error ratio
+     * @param ID the ID of the dislocation
+     */
+    void clearError(const unsigned int & ID);
+
 #ifdef BUILD_PYTHON_BINDINGS
     std::string __str__() const;
     std::string __repr__() const;
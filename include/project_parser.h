@@ -33,7 +33,9 @@ namespace sdddstCore {
 enum ProjectType {
     NONE,
     SIMULATION,
-    EV_ANALYZATION
+    EV_ANALYZATION,
+    RELAXATION,
+    QUASISTATIC_LOADING
 };
 
 class ProjectParser
@@ -0,0 +1,129 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDDDST_CORE_QUASISTATIC_LOADING_H
+#define SDDDST_CORE_QUASISTATIC_LOADING_H
+
+#include "dislocation.h"
+#include "relaxation.h"
+#include "simulation.h"
+#include "simulation_data.h"
+#include "StressProtocols/fixed_rate_protocol.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef BUILD_PYTHON_BINDINGS
+#include <boost/python.hpp>
+#endif
+
+namespace sdddstCore {
+
+/**
+ * @brief The QuasistaticLoading class drives the system with athermal quasistatic loading: the external
+ * stress of the fixed rate protocol is raised in increments and the configuration is relaxed after each of them,
+ * so the avalanches are separated from each other as in the limit of a vanishing loading rate. The increments
+ * are chosen with the help of the force Jacobian J: the smallest eigenvalue of -J vanishes as
+ * sqrt(critical stress - stress) at the next instability, so the critical stress is extrapolated from its square
+ * at the last two equilibria and it is approached in shrinking increments. The new equilibrium is
+ * searched with Newton iterations from the linear response, if they do not converge (an avalanche was triggered)
+ * the configuration is relaxed with FIRE.
+ */
+class QuasistaticLoading
+{
+public:
+    QuasistaticLoading(std::shared_ptr<SimulationData> _sD);
+    ~QuasistaticLoading();
+
+    /**
+     * @brief run loads the system until one of the limits is reached, then the configuration is written into the result file
+     */
+    void run();
+
+    /**
+     * @brief step raises the external stress by one increment and relaxes the configuration
+     * @return true if an avalanche happened during the relaxation
+     */
+    bool step();
+
+    double getStress() const;
+
+#ifdef BUILD_PYTHON_BINDINGS
+    static QuasistaticLoading * create(boost::python::object simulationData);
+#endif
+
+private:
+    /**
+     * @brief factorizeJacobian calculates and factorizes (I - H * J) with a large H at the current configuration
+     */
+    void factorizeJacobian();
+
+    /**
+     * @brief solve multiplies the vector with (I / H - J)^-1 which is close to -J^-1, the result is in ws.x of the big step workspace
+     */
+    void solve(const std::vector<double> & rhs);
+
+    /**
+     * @brief calculateResponse factorizes the Jacobian and calculates the response (dx/dt = -J^-1 b * rate) and the stiffness at the current equilibrium
+     */
+    void calculateResponse();
+
+    /**
+     * @brief newtonRelax searches the equilibrium with Newton iterations
+     * @return the number of iterations if the largest force went below the tolerance, 0 otherwise
+     */
+    size_t newtonRelax();
+
+    std::shared_ptr<SimulationData> sD;
+
+    // The loading parameter is the simulation time of the protocol
+    FixedRateProtocol * protocol;
+
+    // Used for the Jacobian of the forces
+    Simulation simulation;
+
+    Relaxation relaxation;
+
+    // Configuration at the last equilibrium and the derivative of the equilibrium positions with respect to the loading time
+    std::vector<Dislocation> equilibrium;
+    std::vector<double> response;
+
+    // Estimate of the softest mode of the equilibrium, followed with inverse iteration
+    std::vector<double> softMode;
+    bool hasSoftMode;
+
+    // Forces and the right hand side for the Newton iterations
+    std::vector<double> force;
+    std::vector<double> rhs;
+
+    // Square of the smallest eigenvalue of -J at the current and the previous equilibrium (and the time of the latter), it vanishes at the instability
+    double stiffness;
+    double lastStiffness;
+    double lastTime;
+    bool hasLastStiffness;
+    double predictedCriticalStress;
+
+    // Name of the last written sub configuration
+    std::string subConfigFileName;
+};
+
+}
+
+#endif
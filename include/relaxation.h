@@ -0,0 +1,107 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDDDST_CORE_RELAXATION_H
+#define SDDDST_CORE_RELAXATION_H
+
+#include "dislocation.h"
+#include "simulation.h"
+#include "simulation_data.h"
+
+#include <memory>
+#include <vector>
+
+#ifdef BUILD_PYTHON_BINDINGS
+#include <boost/python.hpp>
+#endif
+
+namespace sdddstCore {
+
+/**
+ * @brief The Relaxation class minimizes the energy of the configuration with the FIRE algorithm
+ * (Bitzek et al., PRL 97, 170201) using the same forces as the simulation. It follows the forces
+ * with an inertial dynamics which is stopped whenever it goes uphill, so the relaxed state is found
+ * much faster than with the overdamped dynamics, but the path is not physical. The forces are
+ * preconditioned with the local stiffness (the row sums of the absolute values of the force Jacobian,
+ * strongly coupled pairs are handled together), so the time step is not limited by the closest pairs.
+ */
+class Relaxation
+{
+public:
+    Relaxation(std::shared_ptr<SimulationData> _sD);
+    ~Relaxation();
+
+    /**
+     * @brief run relaxes the configuration, then it is written into the result file
+     */
+    void run();
+
+    /**
+     * @brief relax iterates until the largest force is below the tolerance or the iteration limit is reached
+     * @param logIterations if true every iteration is written into the log
+     */
+    void relax(bool logIterations = true);
+
+    /**
+     * @brief reset restarts the minimizer from the current configuration with the external stress at the current simulation time
+     */
+    void reset();
+
+    /**
+     * @brief step does one FIRE iteration
+     * @return true if the largest force is below the tolerance
+     */
+    bool step();
+
+    double getMaxForce() const;
+    size_t getIterationCount() const;
+
+#ifdef BUILD_PYTHON_BINDINGS
+    static Relaxation * create(boost::python::object simulationData);
+#endif
+
+private:
+    void calculateForces();
+
+    std::shared_ptr<SimulationData> sD;
+
+    // Used for the force calculation
+    Simulation simulation;
+
+    // Forces (the overdamped speeds), the preconditioned forces and the velocities of the inertial dynamics
+    std::vector<double> force;
+    std::vector<double> direction;
+    std::vector<double> velocity;
+
+    // Row sums of the absolute values of the force Jacobian, the strongest coupling and its partner for every dislocation
+    std::vector<double> stiffness;
+    std::vector<size_t> partner;
+    std::vector<double> coupling;
+
+    double timeStep;
+    double alpha;
+    unsigned int stepsSinceUphill;
+    size_t iterations;
+    double maxForce;
+    double rmsForce;
+};
+
+}
+
+#endif
@@ -21,12 +21,17 @@
 #define SDDDST_CORE_SIMULATION_H
 
 #include "dislocation.h"
+#include "integrator_workspace.h"
+#include "log_aggregator.h"
 #include "precision_handler.h"
 #include "simulation_data.h"
+#include "sub_configuration_writer.h"
 #include "StressProtocols/stress_protocol.h"
+#include "StressProtocols/spring_protocol.h"
 
 #include <memory>
 #include <sstream>
+#include <string>
 #include <vector>
 
 #ifdef BUILD_PYTHON_BINDINGS
@@ -41,18 +46,22 @@ public:
     Simulation(std::shared_ptr<SimulationData> _sD);
     ~Simulation();
 
-    void integrate(const double & stepsize, std::vector<Dislocation> &newDislocation, const std::vector<Dislocation> &old, bool useSpeed2, bool calculateInitSpeed, sdddstCore::StressProtocolStepType origin, sdddstCore::StressProtocolStepType end);
+    void integrate(IntegratorWorkspace & ws, const double & stepsize, std::vector<Dislocation> &newDislocation, const std::vector<Dislocation> &old, bool useSpeed2, bool calculateInitSpeed, sdddstCore::StressProtocolStepType origin, sdddstCore::StressProtocolStepType end, bool startFromOld = false);
     void calculateSpeeds(const std::vector<Dislocation> & dis, std::vector<double>  & res, bool ignorePHUpdate = false);
-    void calculateG(const double & stepsize, std::vector<Dislocation> &newDislocation, const std::vector<Dislocation> &old, bool useSpeed2, bool calculateInitSpeed, bool useInitSpeedForFirstStep, StressProtocolStepType origin, StressProtocolStepType end);
-    void calculateJacobian(const double &stepsize, const std::vector<Dislocation> &data);
+    void calculateSpeeds(const std::vector<Dislocation> & dis, std::vector<double>  & res, StressProtocolStepType type, PrecisionHandler * ph);
+    void calculateInitSpeed(IntegratorWorkspace & ws, const std::vector<Dislocation> &old, std::vector<double> & isp, StressProtocolStepType origin);
+    void predict(std::vector<Dislocation> &newDislocation, const std::vector<Dislocation> &old, const std::vector<double> & speed, const std::vector<double> & previousSpeed, double previousStepSize, const double & stepsize, unsigned int order);
+    void calculateG(IntegratorWorkspace & ws, const double & stepsize, const std::vector<Dislocation> &newDislocation, const std::vector<Dislocation> &old, bool useSpeed2, bool calculateInitSpeed, bool useInitSpeedForFirstStep, StressProtocolStepType origin, StressProtocolStepType end);
+    void calculateJacobian(IntegratorWorkspace & ws, const double &stepsize, const std::vector<Dislocation> &data, double gamma = 0);
+    double calculatePointDefectJacobianDiagonal(const Dislocation & d);
     void calculateXError();
 
-    void calculateSparseFormForJacobian();
-    void solveEQSys();
+    void calculateSparseFormForJacobian(IntegratorWorkspace & ws);
+    void solveEQSys(IntegratorWorkspace & ws);
 
     double calculateOrderParameter(const std::vector<double> & speeds);
 
-    double getElement(int j, int si, int ei);
+    double getElement(const IntegratorWorkspace & ws, int j, int si, int ei);
 
     double getSimTime();
 
@@ -64,25 +73,150 @@ public:
     void stepStageII();
     void stepStageIII();
 
+    /**
+     * @brief stepStagesIAndII does the same as stepStageI and stepStageII, but the two integrations are
+     * running on separate threads
+     */
+    void stepStagesIAndII();
+
+    /**
+     * @brief stepEmbedded integrates only one step and estimates its error from the difference of an
+     * explicit predictor and the implicit corrector
+     */
+    void stepEmbedded();
+
+    /**
+     * @brief stepRosenbrock does a step with the ROS34PW2 Rosenbrock-W method, the Jacobian is
+     * calculated and factorized only once for the four stages
+     */
+    void stepRosenbrock();
+
+    /**
+     * @brief stepSpeculative tries the step with halved step sizes at the same time on separate threads and
+     * the largest accepted one is used, the result is the same as if only that step size had been tried
+     */
+    void stepSpeculative();
+
     const std::vector<Dislocation> & getStoredDislocationData();
 
+    SubConfigurationWriter & getSubConfigurationWriter();
+
+    /**
+     * @brief writeCheckpoint saves every state needed to continue the simulation exactly, it should be called
+     * after a successful step. The output is flushed and its size is saved, so the output written after the
+     * checkpoint can be dropped on restart.
+     * @param path
+     */
+    void writeCheckpoint(const std::string & path);
+
+    /**
+     * @brief readCheckpoint continues the simulation from a checkpoint written with the same parameters
+     * @param path
+     */
+    void readCheckpoint(const std::string & path);
+
 #ifdef BUILD_PYTHON_BINDINGS
     static Simulation * create(boost::python::object simulationData);
 #endif
 
 private:
+    void beginStep();
+    void integrateBigStep();
+    void estimateStepError();
+
+    /**
+     * @brief extrapolateSecondSmallStep moves the result of the two half steps away from the big step by the third of their difference,
+     * the dislocations integrated with substeps and the damped ones are skipped
+     */
+    void extrapolateSecondSmallStep();
+
+    /// True if the dislocation is extrapolated: the trapezoidal rule is damped only a little for it, so its error is second order
+    bool isExtrapolated(unsigned int i) const;
+    void attemptStep();
+    bool attemptIsAccepted() const;
+    void finishStep(std::vector<Dislocation> & result, const std::vector<Dislocation> * halfway, const std::vector<double> & lastSpeed, double lastVSquare, double lastInterval);
+
+    /**
+     * @brief stepFastDislocations integrates the dislocations which missed the precision in the current step (or are bound in dipoles)
+     * with substeps while the positions of the others are interpolated between the start and the end of the step
+     * @return true if the fast dislocations are integrated with the required precision
+     */
+    bool stepFastDislocations();
+
+    /**
+     * @brief detectDipoles collects the dislocation pairs with opposite Burgers vectors closer than the dipole distance
+     * at the beginning of the step, the newly formed and the released dipoles are counted and reported
+     */
+    void detectDipoles();
+
+    /**
+     * @brief annihilateDislocations removes the pairs with opposite Burgers vectors closer than the annihilation distance
+     * (the closest ones first), the events are counted and reported
+     */
+    void annihilateDislocations();
+    bool integrateFastDislocations(unsigned int substeps);
+    void integrateFastSubsystem(const double & stepsize, std::vector<Dislocation> & newDislocation, const std::vector<Dislocation> & old, double startTime);
+    void calculateFastSpeeds(const std::vector<Dislocation> & dis, std::vector<double> & res, double time);
+    void calculateFastJacobian(const double & stepsize, const std::vector<Dislocation> & data);
+    void interpolateSlowDislocations(std::vector<Dislocation> & dis, double fraction);
+
+    /**
+     * @brief getSpringProtocol checks the type of the external stress protocol without comparing type strings
+     * @return the protocol if it is a spring protocol, nullptr otherwise
+     */
+    SpringProtocol * getSpringProtocol() const;
+
+    /// Writes a row selected by the log aggregator into the binary or the text log ("-" for the missing values)
+    void writeAggregatedLogRow(const double * values);
+
     bool succesfulStep;
     double lastWriteTimeFinished;
     bool initSpeedCalculationIsNeeded;
     bool firstStepRequest;
+    bool bigStepIsReady;
     double energy;
     double energyAccum;
     double vsquare;
     double vsquare1;
     double vsquare2;
+    size_t newtonIterations;
+    std::vector<double> lastInitSpeed;
+    double lastStepSize;
+
+    // Multirate stepping: IDs of the fast dislocations, their index in the subsystem (-1 for the slow ones),
+    // the solver buffers and the configurations of the substeps
+    std::vector<unsigned int> fastIDs;
+    std::vector<int> fastIndex;
+    IntegratorWorkspace fastWorkspace;
+    std::vector<double> fastInitSpeed;
+    std::vector<Dislocation> fastCurrent;
+    std::vector<Dislocation> fastBig;
+    std::vector<Dislocation> fastHalf;
+    std::vector<Dislocation> fastEnd;
+
+    // The bound dipoles (ordered pairs of IDs) and the flags of their members
+    std::vector<std::pair<unsigned int, unsigned int> > boundPairs;
+    std::vector<std::pair<unsigned int, unsigned int> > detectedPairs;
+    std::vector<bool> isBound;
+
+    // Reused buffers of the annihilation: the close pairs with their squared distances and the removed IDs
+    std::vector<std::pair<double, std::pair<unsigned int, unsigned int> > > annihilationCandidates;
+    std::vector<unsigned int> annihilatedIDs;
+
+    // Simulations trying the halved step sizes in speculative mode
+    std::vector<std::unique_ptr<Simulation> > trials;
+
+    // Reused buffer for the path of the sub-configurations
+    std::string subConfigFileName;
 
     std::shared_ptr<SimulationData> sD;
     std::unique_ptr<PrecisionHandler> pH;
+
+    // Writes the sub-configurations on a background thread
+    SubConfigurationWriter subConfigWriter;
+
+    // Selects the steps written into the log, not set if every step is written
+    std::unique_ptr<LogAggregator> logAggregator;
 };
 
 }
@@ -20,10 +20,15 @@
 #ifndef SDDDST_CORE_SIMULATION_DATA_H
 #define SDDDST_CORE_SIMULATION_DATA_H
 
+#include "binary_log.h"
+#include "checkpoint.h"
 #include "dislocation.h"
+#include "integrator_workspace.h"
 #include "point_defect.h"
 #include "Fields/Field.h"
+#include "StepSizeControllers/step_size_controller.h"
 #include "StressProtocols/stress_protocol.h"
+#include "trajectory.h"
 
 #include <fstream>
 #include <string>
@@ -36,6 +41,16 @@
 
 namespace sdddstCore {
 
+enum IntegratorType
+{
+    // Damped trapezoidal rule, the error is estimated with step doubling
+    TrapezoidalStepDoubling,
+    // Damped trapezoidal rule, the error is estimated from the difference to an explicit predictor
+    TrapezoidalEmbedded,
+    // Third order Rosenbrock-W method ROS34PW2 with embedded second order error estimate
+    RosenbrockW
+};
+
 class SimulationData
 {
 public:
@@ -55,6 +70,8 @@ public:
     /// Data file handling utilities
     void readDislocationDataFromFile(const std::string & dislocationDataFilePath);
     void writeDislocationDataToFile(const std::string & dislocationDataFilePath);
+    static void writeDislocationsToFile(const std::string & dislocationDataFilePath, const std::vector<Dislocation> & dislocations);
+    void readDislocationDataFromTrajectory(TrajectoryReader & trajectory, size_t frame);
     void readPointDefectDataFromFile(const std::string & pointDefectDataFilePath);
     void writePointDefectDataToFile(const std::string & pointDefectDataFilePath);
 
@@ -62,23 +79,41 @@ public:
     void initSimulationVariables();
     void updateCutOff();
 
+    /**
+     * @brief copyRunConstants copies the point defects and clones the stress protocol of another object,
+     * they do not change during the run, so it is called only once before copyStepState
+     * @param other the data of the simulation
+     */
+    void copyRunConstants(const SimulationData & other);
+
+    /**
+     * @brief copyStepState copies everything else which is needed to try a step from another object,
+     * so the step can be tried independently on another thread (the field is shared, only the stress values are copied)
+     * @param other the data of the simulation
+     */
+    void copyStepState(const SimulationData & other);
+
+    /// Saves and restores the state which changes during the simulation (used by the checkpoints)
+    void writeCheckpoint(CheckpointWriter & writer) const;
+    void readCheckpoint(CheckpointReader & reader);
+
+    /**
+     * @brief removeDislocations removes the given dislocations and shrinks the buffers depending on the dislocation count
+     * in place, the order of the others is kept
+     * @param IDs indexes of the dislocations to remove in increasing order
+     */
+    void removeDislocations(const std::vector<unsigned int> & IDs);
+
     //////////////////
     /// DATA FIELDS
     ///
 
     std::vector<Dislocation> dislocations; //Valid dislocation position data -> state of the simulation at simTime
     std::vector<PointDefect> points; //The positions of the fix points
-    std::vector<double> g; // the g vector from the calculations
     // Used to store initial speeds for the big step and for the first small step
     std::vector<double> initSpeed;
     // Used to store initial speeds for the second small step
     std::vector<double> initSpeed2;
-    // Stores speed during the NR iteration for the big step and for the first small step
-    std::vector<double> speed;
-    // Stores speed during the NR iteration for the second small step
-    std::vector<double> speed2;
-    // Stores the d values for the integration scheme
-    std::vector<double> dVec;
 
     // The value of the cut off multiplier
     double cutOffMultiplier;
@@ -104,6 +139,25 @@ public:
     // Count of the iterations during the NR
     unsigned int ic;
 
+    // True if the NR iteration stops on convergence instead of doing exactly ic iterations
+    bool isNewtonConvergenceControlled;
+
+    // The NR iteration is converged if the largest correction is below newtonTolerance * prec
+    double newtonTolerance;
+
+    // Lower and upper limit of the NR iteration count if it is convergence controlled
+    unsigned int minIterationCount;
+    unsigned int maxIterationCount;
+
+    // Order of the explicit predictor for the NR initial guess (0: the old positions are used)
+    unsigned int predictorOrder;
+
+    // The integration scheme used for the steps
+    IntegratorType integrator;
+
+    // True if the accepted steps of the step doubling are improved with Richardson extrapolation from the big step
+    bool richardsonExtrapolation;
+
     // Simulation time limit. After it is reached there should be no more calculations
     double timeLimit;
 
@@ -127,21 +181,68 @@ public:
     std::vector<Dislocation> secondSmall;
 
     // The used field
-    std::unique_ptr<Field> tau;
+    std::shared_ptr<Field> tau;
+
+    // Solver buffers of the big step (also used by the second small step) and of the first small step
+    IntegratorWorkspace bigStepWorkspace;
+    IntegratorWorkspace smallStepWorkspace;
+
+    // True if the big step and the first small step should be integrated on separate threads
+    bool concurrentStages;
+
+    // True if a rejected step's first small step should be used as the next big step (the step size is halved)
+    bool reuseHalfStep;
+
+    // Number of the big steps which were taken over from a rejected step
+    size_t reusedHalfSteps;
+
+    // Maximum number of substeps for the fast dislocations in multirate mode (multirate mode is off below 2)
+    unsigned int multirateMaxSubsteps;
+
+    // Maximum ratio of the fast dislocations in a multirate step, otherwise the step is rejected as usual
+    double multirateMaxFastRatio;
 
-    // UMFPack specified sparse format stored Jacobian
-    int * Ap;
-    int * Ai;
-    double * Ax;
-    // Result data
-    double * x;
+    // Number of the steps where the fast dislocations were integrated with substeps
+    size_t multirateSteps;
 
-    // UMFPack required variables
-    double *null;
-    void *Symbolic, *Numeric;
+    // True if dislocation pairs with opposite Burgers vectors closer than dipoleDistance are integrated
+    // separately with substeps, so they do not limit the global step size
+    bool isDipoleTreatment;
 
-    // Diagonal indexes in the Jacobian
-    std::vector<int> indexes;
+    // Distance under which two dislocations with opposite Burgers vectors are considered as a bound dipole
+    double dipoleDistance;
+
+    // Number of the step sizes tried at the same time in speculative mode (stepSize, stepSize/2, ...), off below 2
+    unsigned int speculativeTrials;
+
+    // Relaxation mode: the minimization stops if the largest force is below the tolerance or after the given number of iterations
+    double relaxationForceTolerance;
+    unsigned int relaxationMaxIterations;
+
+    // Quasistatic loading mode: the largest stress increment between two relaxations and the plastic strain
+    // of a relaxation above which it is counted as an avalanche
+    double aqsStressStep;
+    double aqsAvalancheStrain;
+
+    // Strain increments (sum of b*dx) of the step buffers, kept up to date while they are integrated:
+    // bigStep and firstSmall are measured from dislocations, secondSmall from firstSmall
+    double bigStepStrainIncrement;
+    double firstSmallStrainIncrement;
+    double secondSmallStrainIncrement;
+
+    // Number of the dipoles formed and released during the simulation
+    size_t dipoleBindings;
+    size_t dipoleReleases;
+
+    // True if dislocations with opposite Burgers vectors closer than annihilationDistance are removed after the successful steps
+    bool isAnnihilation;
+    double annihilationDistance;
+
+    // Number of the annihilated dislocation pairs
+    size_t annihilations;
+
+    // Heap allocations during the last step, only counted in builds with the COUNT_HEAP_ALLOCATIONS cmake option
+    size_t stepHeapAllocations;
 
     // Number of the successfuly finished steps
     size_t succesfulSteps;
@@ -196,12 +297,27 @@ public:
     // The standard log entries will be written into this stream
     std::ofstream standardOutputLog;
 
+    // If set, the standard log entries are written into this binary log instead
+    std::unique_ptr<BinaryLog> binaryLog;
+
+    // If not zero only every logStepInterval-th successful step is written into the log
+    unsigned int logStepInterval;
+
+    // If positive the log contains the minimum, mean and maximum of the columns in windows of this simulation time
+    double logTimeWindow;
+
+    // True if every step of the avalanches is written into the log (only these steps if there is no other selection)
+    bool logFullDuringAvalanche;
+
     // The final configuration will be written into this file
     std::string endDislocationConfigurationPath;
 
     // External stress can be applied to the simulation with a specified protocol
     std::unique_ptr<StressProtocol> externalStressProtocol;
 
+    // Calculates the step size of the next attempt from the error of the current one
+    std::unique_ptr<StepSizeController> stepSizeController;
+
     // True if avalanches should be counted for limit
     bool countAvalanches;
 
@@ -223,6 +339,27 @@ public:
     // The path where the sub configs should be saved
     std::string subConfigPath;
 
+    // If not empty the sub configs are appended to this trajectory file instead of separate files
+    std::string trajectoryPath;
+
+    // The number of frames in a chunk of the trajectory
+    unsigned int trajectoryChunkSize;
+
+    // True if the chunks of the trajectory should be compressed
+    bool compressTrajectory;
+
+    // True if the x coordinates in the trajectory should be stored as differences quantised with the precision
+    bool deltaEncodeTrajectory;
+
+    // If not empty the state of the simulation is saved into this file periodically and on SIGTERM
+    std::string checkpointPath;
+
+    // The number of successful steps between two checkpoints, they are written only on SIGTERM if it is zero
+    unsigned int checkpointInterval;
+
+    // If not empty the simulation is continued from this checkpoint
+    std::string restartPath;
+
     // The number of successful steps between two sub config output
     unsigned int subConfigDelay;
 
@@ -232,6 +369,15 @@ public:
     // The number of elapsed steps since the last subconfig written
     unsigned int subconfigDistanceCounter;
 
+    // The number of sub configs which can wait for the background writer before the simulation is blocked
+    unsigned int subConfigQueueSize;
+
+    // The largest number of sub configs waiting for the writer at the same time
+    size_t subConfigQueueMaxDepth;
+
+    // The wall time the simulation spent waiting for a free place in the sub config queue
+    double subConfigBlockedTime;
+
     // What kind of stress state should be used
     sdddstCore::StressProtocolStepType currentStressStateType;
 
@@ -240,8 +386,6 @@ public:
 
     bool isSpeedThresholdForCutoffChange;
 
-    unsigned currentStorageSize;
-
     double sumAvgSpeed;
 
     std::string eVAnalResultFile;
@@ -256,6 +400,9 @@ public:
 
 #ifdef BUILD_PYTHON_BINDINGS
 
+    std::vector<double> &getG();
+    std::vector<double> &getDVec();
+
     Field const &getField();
     void setField(boost::python::object field);
 
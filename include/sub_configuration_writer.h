@@ -0,0 +1,107 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDDDST_CORE_SUB_CONFIGURATION_WRITER_H
+#define SDDDST_CORE_SUB_CONFIGURATION_WRITER_H
+
+#include "dislocation.h"
+#include "trajectory.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sdddstCore {
+
+/**
+ * @brief SubConfigurationWriter writes the sub-configurations on a background thread. The states are copied
+ * into a fixed number of reused slots, if all of them are waiting to be written the caller is blocked until
+ * one of them is free. The configurations are written either into separate files or into a trajectory.
+ */
+class SubConfigurationWriter
+{
+public:
+    SubConfigurationWriter(unsigned int capacity);
+    ~SubConfigurationWriter();
+
+    /**
+     * @brief setTrajectory makes the writer append the configurations to a trajectory file instead of
+     * separate files, the file is opened when the first configuration is written
+     * @param path of the trajectory
+     * @param framesPerChunk the number of frames in a chunk of the trajectory
+     * @param encoding of the chunks
+     * @param quantisation of the delta encoded coordinates
+     * @param append if true an existing trajectory is continued, otherwise it is overwritten
+     */
+    void setTrajectory(const std::string & path, unsigned int framesPerChunk, TrajectoryEncoding encoding, double quantisation, bool append);
+
+    /**
+     * @brief push copies the configuration into the queue, the writer thread is started by the first call
+     * @param path of the file to write (not used with a trajectory)
+     * @param time of the configuration
+     * @param dislocations to save
+     */
+    void push(const std::string & path, double time, const std::vector<Dislocation> & dislocations);
+
+    /// Waits until every queued configuration is written, the last chunk of the trajectory is written as well
+    void flush();
+
+    /// The largest number of configurations waiting at the same time
+    size_t getMaxDepth() const;
+
+    /// The wall time spent in push waiting for a free slot
+    double getBlockedTime() const;
+
+private:
+    void work();
+
+    struct Slot
+    {
+        std::string path;
+        double time;
+        std::vector<Dislocation> dislocations;
+    };
+
+    std::vector<Slot> slots;
+    // The oldest queued slot and the number of queued slots
+    size_t head;
+    size_t depth;
+    size_t maxDepth;
+    double blockedTime;
+    bool stop;
+
+    std::string trajectoryPath;
+    unsigned int trajectoryChunkSize;
+    TrajectoryEncoding trajectoryEncoding;
+    double trajectoryQuantisation;
+    bool trajectoryAppend;
+    std::unique_ptr<TrajectoryWriter> trajectory;
+
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::condition_variable written;
+    std::thread writer;
+};
+
+}
+
+#endif
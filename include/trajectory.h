@@ -0,0 +1,171 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDDDST_CORE_TRAJECTORY_H
+#define SDDDST_CORE_TRAJECTORY_H
+
+#include "dislocation.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sdddstCore {
+
+/**
+ * A trajectory file starts with a header (magic number and version) and contains chunks which are only
+ * appended. Every chunk starts with its header and the index of its frames (time, number of dislocations,
+ * offset in the payload), followed by the payload which holds the x, y and b columns of every frame and
+ * can be compressed or delta encoded. A chunk is written at once, so a reader only has to check that the whole chunk is
+ * present to follow a trajectory which is still being written.
+ */
+enum TrajectoryEncoding
+{
+    // The columns as doubles
+    TrajectoryRaw = 0,
+    // The columns as doubles compressed with zlib
+    TrajectoryZlib = 1,
+    // The first frame of the chunk is stored as it is, the x coordinates of the next frames are quantised
+    // differences to the previous frame if the dislocations did not change otherwise, compressed with zlib
+    TrajectoryDelta = 2
+};
+
+struct TrajectoryFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct TrajectoryChunkHeader
+{
+    uint32_t encoding;
+    uint32_t frameCount;
+    uint64_t storedSize;
+    uint64_t rawSize;
+};
+
+struct TrajectoryFrameIndex
+{
+    double time;
+    uint64_t count;
+    uint64_t offset;
+};
+
+/**
+ * @brief isTrajectoryFile checks the magic number at the beginning of the file, pipes are not trajectories
+ */
+bool isTrajectoryFile(const std::string & path);
+
+/**
+ * @brief TrajectoryWriter collects the frames and appends them to the file chunk by chunk
+ */
+class TrajectoryWriter
+{
+public:
+    /**
+     * @param path of the trajectory
+     * @param framesPerChunk the number of frames collected before a chunk is written (the distance of the key frames)
+     * @param encoding of the chunks
+     * @param quantisation the resolution of the delta encoded x coordinates, their error is at most the half of it
+     * @param append if true an existing trajectory is continued (restart), otherwise it is overwritten
+     */
+    TrajectoryWriter(const std::string & path, unsigned int framesPerChunk, TrajectoryEncoding encoding, double quantisation = 0, bool append = false);
+    ~TrajectoryWriter();
+
+    void addFrame(double time, const std::vector<Dislocation> & dislocations);
+
+    /// Writes the collected frames as a (possibly shorter) chunk
+    void flush();
+
+private:
+    /// Encodes the collected frames into encoded
+    void deltaEncode();
+
+    std::ofstream out;
+    unsigned int framesPerChunk;
+    TrajectoryEncoding encoding;
+    double quantisation;
+
+    std::vector<TrajectoryFrameIndex> frames;
+    std::vector<double> payload;
+    std::string encoded;
+    std::string compressed;
+    // The x coordinates of the previous frame as they are decoded
+    std::vector<double> reconstructed;
+};
+
+/**
+ * @brief TrajectoryReader indexes the frames of a trajectory file and reads them one by one
+ */
+class TrajectoryReader
+{
+public:
+    TrajectoryReader(const std::string & path);
+
+    /**
+     * @brief update indexes the chunks appended since the last call
+     * @return the number of new frames
+     */
+    size_t update();
+
+    size_t getFrameCount() const;
+    double getTime(size_t frame) const;
+
+    /// The size of the file up to the end of the last complete chunk
+    uint64_t getIndexedSize() const;
+
+    /// Reads the frame into dislocations, the chunk of the last read frame is kept decoded
+    void readFrame(size_t frame, std::vector<Dislocation> & dislocations);
+
+private:
+    struct Frame
+    {
+        size_t chunk;
+        TrajectoryFrameIndex index;
+    };
+
+    struct Chunk
+    {
+        TrajectoryChunkHeader header;
+        uint64_t payloadOffset;
+        size_t firstFrame;
+    };
+
+    void loadChunk(size_t chunk);
+
+    /// Decodes the delta encoded chunk from decompressed into payload
+    void deltaDecode(size_t chunk);
+
+    std::string path;
+    std::ifstream in;
+    uint64_t indexedSize;
+    std::vector<Chunk> chunks;
+    std::vector<Frame> frames;
+
+    size_t loadedChunk;
+    std::vector<double> payload;
+    std::string stored;
+    std::string decompressed;
+};
+
+}
+
+#endif
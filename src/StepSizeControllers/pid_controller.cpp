@@ -0,0 +1,119 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "StepSizeControllers/pid_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+sdddstCore::PIDController::PIDController(double integralGain, double proportionalGain, double derivativeGain):
+    StepSizeController(),
+    kI(integralGain),
+    kP(proportionalGain),
+    kD(derivativeGain),
+    lastErrorRatio(0),
+    secondLastErrorRatio(0),
+    lastRejected(false)
+{
+    // Nothing to do
+}
+
+sdddstCore::PIDController::~PIDController()
+{
+    // Nothing to do
+}
+
+double sdddstCore::PIDController::getNewStepSize(double oldStepSize, double errorRatioSqr, bool accepted)
+{
+    // Without history or after a failed NR iteration the elementary controller is used
+    if (!(errorRatioSqr == errorRatioSqr) || (accepted && lastErrorRatio == 0))
+    {
+        if (accepted)
+        {
+            lastErrorRatio = std::max(sqrt(errorRatioSqr), 1e-10);
+            lastRejected = false;
+        }
+        return StepSizeController::getNewStepSize(oldStepSize, errorRatioSqr, accepted);
+    }
+
+    // The error is proportional to the step size on the power of the order of the integrator's error estimate
+    const double k = errorOrder;
+    double errorRatio = std::max(sqrt(errorRatioSqr), 1e-10);
+    double factor;
+    if (!accepted)
+    {
+        factor = pow(errorRatio, -1./k);
+        lastRejected = true;
+    }
+    else
+    {
+        factor = pow(errorRatio, -(kI + kP + kD) / k) * pow(lastErrorRatio, (kP + 2.0 * kD) / k);
+        if (secondLastErrorRatio > 0)
+        {
+            factor *= pow(secondLastErrorRatio, -kD / k);
+        }
+        else
+        {
+            factor *= pow(lastErrorRatio, -kD / k);
+        }
+
+        // The step size is not increased right after a rejection
+        if (lastRejected)
+        {
+            factor = std::min(factor, 1.0 / 0.9);
+        }
+
+        secondLastErrorRatio = lastErrorRatio;
+        lastErrorRatio = errorRatio;
+        lastRejected = false;
+    }
+
+    factor = std::min(std::max(0.9 * factor, 0.2), 2.0);
+    return oldStepSize * factor;
+}
+
+void sdddstCore::PIDController::reset()
+{
+    lastErrorRatio = 0;
+    secondLastErrorRatio = 0;
+    lastRejected = false;
+}
+
+std::string sdddstCore::PIDController::getType()
+{
+    if (kD == 0)
+    {
+        return "pi";
+    }
+    return "pid";
+}
+
+void sdddstCore::PIDController::writeCheckpoint(sdddstCore::CheckpointWriter &writer) const
+{
+    writer.write(lastErrorRatio);
+    writer.write(secondLastErrorRatio);
+    writer.write(lastRejected);
+}
+
+void sdddstCore::PIDController::readCheckpoint(sdddstCore::CheckpointReader &reader)
+{
+    reader.read(lastErrorRatio);
+    reader.read(secondLastErrorRatio);
+    reader.read(lastRejected);
+}
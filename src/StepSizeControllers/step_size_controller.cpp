@@ -0,0 +1,82 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "StepSizeControllers/step_size_controller.h"
+#include "constants.h"
+
+#include <cmath>
+
+sdddstCore::StepSizeController::StepSizeController():
+    errorOrder(DEFAULT_ERROR_ESTIMATE_ORDER)
+{
+    // Nothing to do
+}
+
+sdddstCore::StepSizeController::~StepSizeController()
+{
+    // Nothing to do
+}
+
+double sdddstCore::StepSizeController::getNewStepSize(double oldStepSize, double errorRatioSqr, bool)
+{
+    if (0.0 == errorRatioSqr)
+    {
+        return oldStepSize * 2.0;
+    }
+
+    double tmp = 1./sqrt(errorRatioSqr);
+
+    tmp = pow(tmp, 1./errorOrder);
+    if (tmp > 2.0)
+    {
+        tmp = 2.0;
+    }
+
+    return 0.9 * oldStepSize * tmp;
+}
+
+void sdddstCore::StepSizeController::reset()
+{
+    // Nothing to do
+}
+
+std::string sdddstCore::StepSizeController::getType()
+{
+    return "elementary";
+}
+
+void sdddstCore::StepSizeController::writeCheckpoint(sdddstCore::CheckpointWriter &) const
+{
+    // Nothing to do
+}
+
+void sdddstCore::StepSizeController::readCheckpoint(sdddstCore::CheckpointReader &)
+{
+    // Nothing to do
+}
+
+void sdddstCore::StepSizeController::setErrorOrder(double value)
+{
+    errorOrder = value;
+}
+
+double sdddstCore::StepSizeController::getErrorOrder() const
+{
+    return errorOrder;
+}
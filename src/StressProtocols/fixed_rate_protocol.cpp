@@ -82,6 +82,43 @@ std::string sdddstCore::FixedRateProtocol::getType()
     return "fixed-rate-stress";
 }
 
+std::unique_ptr<sdddstCore::StressProtocol> sdddstCore::FixedRateProtocol::clone() const
+{
+    FixedRateProtocol * result = new FixedRateProtocol();
+    result->rate = rate;
+    result->copyStressValues(*this);
+    return std::unique_ptr<StressProtocol>(result);
+}
+
+void sdddstCore::FixedRateProtocol::copyState(const sdddstCore::StressProtocol &other)
+{
+    copyStressValues(static_cast<const FixedRateProtocol &>(other));
+}
+
+void sdddstCore::FixedRateProtocol::writeCheckpoint(sdddstCore::CheckpointWriter &writer) const
+{
+    for (int i = 0; i < 4; i++)
+    {
+        writer.write(stressValues[i]);
+    }
+}
+
+void sdddstCore::FixedRateProtocol::readCheckpoint(sdddstCore::CheckpointReader &reader)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        reader.read(stressValues[i]);
+    }
+}
+
+void sdddstCore::FixedRateProtocol::copyStressValues(const FixedRateProtocol &other)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        stressValues[i] = other.stressValues[i];
+    }
+}
+
 double sdddstCore::FixedRateProtocol::getRate() const
 {
     return rate;
@@ -58,6 +58,14 @@ std::string sdddstCore::SpringProtocol::getType()
     return "spring-stress";
 }
 
+std::unique_ptr<sdddstCore::StressProtocol> sdddstCore::SpringProtocol::clone() const
+{
+    SpringProtocol * result = new SpringProtocol();
+    result->rate = rate;
+    result->springConstant = springConstant;
+    result->copyStressValues(*this);
+    return std::unique_ptr<StressProtocol>(result);
+}
 
 double sdddstCore::SpringProtocol::getSpringConstant() const
 {
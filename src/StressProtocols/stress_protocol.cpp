@@ -55,3 +55,23 @@ std::string sdddstCore::StressProtocol::getType()
 {
     return "zero-stress";
 }
+
+std::unique_ptr<sdddstCore::StressProtocol> sdddstCore::StressProtocol::clone() const
+{
+    return std::unique_ptr<StressProtocol>(new StressProtocol());
+}
+
+void sdddstCore::StressProtocol::copyState(const sdddstCore::StressProtocol &)
+{
+    //Nothing to do
+}
+
+void sdddstCore::StressProtocol::writeCheckpoint(sdddstCore::CheckpointWriter &) const
+{
+    //Nothing to do
+}
+
+void sdddstCore::StressProtocol::readCheckpoint(sdddstCore::CheckpointReader &)
+{
+    //Nothing to do
+}
@@ -0,0 +1,241 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "binary_log.h"
+#include "constants.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace sdddstCore;
+
+BinaryLog::BinaryLog(const std::string &path, bool append):
+    path(path),
+    columns(0),
+    pending(false),
+    stop(false)
+{
+    std::ifstream existing(path, std::ios::binary | std::ios::ate);
+    append = append && existing.is_open() && existing.tellg() > 0;
+    existing.close();
+
+    if (append)
+    {
+        columns = BinaryLogReader(path).getColumnNames().size();
+        out.open(path, std::ios::binary | std::ios::app | std::ios::ate);
+    }
+    else
+    {
+        out.open(path, std::ios::binary | std::ios::trunc);
+    }
+
+    if (!out.is_open())
+    {
+        std::cerr << "Cannot open " << path << " to write!" << std::endl;
+        exit(-1);
+    }
+
+    if (append)
+    {
+        start();
+    }
+}
+
+BinaryLog::~BinaryLog()
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    handedOver.notify_one();
+    if (writer.joinable())
+    {
+        writer.join();
+    }
+}
+
+void BinaryLog::setColumns(const std::vector<std::string> &names)
+{
+    if (columns > 0)
+    {
+        std::cerr << "The columns of " << path << " are already set!" << std::endl;
+        exit(-1);
+    }
+    columns = names.size();
+
+    BinaryLogHeader header;
+    memcpy(header.magic, BINARY_LOG_MAGIC, sizeof(header.magic));
+    header.version = BINARY_LOG_VERSION;
+    header.columns = uint32_t(columns);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (auto & name: names)
+    {
+        char padded[BINARY_LOG_COLUMN_NAME_LENGTH] = {};
+        strncpy(padded, name.c_str(), BINARY_LOG_COLUMN_NAME_LENGTH - 1);
+        out.write(padded, BINARY_LOG_COLUMN_NAME_LENGTH);
+    }
+    out.flush();
+
+    start();
+}
+
+size_t BinaryLog::getColumnCount() const
+{
+    return columns;
+}
+
+void BinaryLog::addRow(const double *values)
+{
+    filling.insert(filling.end(), values, values + columns);
+    if (filling.size() >= columns * BINARY_LOG_BUFFER_ROWS)
+    {
+        handOver();
+    }
+}
+
+void BinaryLog::flush()
+{
+    if (!writer.joinable())
+    {
+        return;
+    }
+    handOver();
+    std::unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [this] { return !pending; });
+    out.flush();
+}
+
+int64_t BinaryLog::getSize()
+{
+    flush();
+    return int64_t(out.tellp());
+}
+
+void BinaryLog::start()
+{
+    filling.reserve(columns * BINARY_LOG_BUFFER_ROWS);
+    writing.reserve(columns * BINARY_LOG_BUFFER_ROWS);
+    writer = std::thread(&BinaryLog::work, this);
+}
+
+void BinaryLog::handOver()
+{
+    // Waits for the previous buffer, so at most two buffers are in use
+    std::unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [this] { return !pending; });
+    std::swap(filling, writing);
+    pending = true;
+    lock.unlock();
+    handedOver.notify_one();
+}
+
+void BinaryLog::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        handedOver.wait(lock, [this] { return pending || stop; });
+        if (!pending)
+        {
+            return;
+        }
+
+        // The buffer is not touched by the other thread while it is pending
+        lock.unlock();
+        out.write(reinterpret_cast<const char*>(writing.data()), std::streamsize(writing.size() * sizeof(double)));
+        writing.clear();
+        lock.lock();
+
+        pending = false;
+        written.notify_all();
+    }
+}
+
+BinaryLogReader::BinaryLogReader(const std::string &path):
+    path(path),
+    in(path, std::ios::binary),
+    headerSize(0)
+{
+    BinaryLogHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            memcmp(header.magic, BINARY_LOG_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != BINARY_LOG_VERSION)
+    {
+        std::cerr << "Invalid binary log file " << path << std::endl;
+        exit(-1);
+    }
+
+    for (uint32_t i = 0; i < header.columns; i++)
+    {
+        char padded[BINARY_LOG_COLUMN_NAME_LENGTH];
+        in.read(padded, BINARY_LOG_COLUMN_NAME_LENGTH);
+        names.push_back(std::string(padded, strnlen(padded, BINARY_LOG_COLUMN_NAME_LENGTH)));
+    }
+    if (!in || names.empty())
+    {
+        std::cerr << "Invalid binary log file " << path << std::endl;
+        exit(-1);
+    }
+    headerSize = sizeof(header) + header.columns * BINARY_LOG_COLUMN_NAME_LENGTH;
+}
+
+std::vector<std::string> BinaryLogReader::getColumnNames() const
+{
+    return names;
+}
+
+size_t BinaryLogReader::getRowCount()
+{
+    in.clear();
+    in.seekg(0, std::ios::end);
+    return size_t((uint64_t(in.tellg()) - headerSize) / (names.size() * sizeof(double)));
+}
+
+std::vector<double> BinaryLogReader::getColumn(size_t column)
+{
+    if (column >= names.size())
+    {
+        return std::vector<double>();
+    }
+    size_t rows = getRowCount();
+    std::vector<double> values(rows);
+    std::vector<double> row(names.size());
+    in.seekg(std::streamoff(headerSize));
+    for (size_t i = 0; i < rows; i++)
+    {
+        in.read(reinterpret_cast<char*>(row.data()), std::streamsize(row.size() * sizeof(double)));
+        values[i] = row[column];
+    }
+    return values;
+}
+
+std::vector<double> BinaryLogReader::getColumnByName(const std::string &name)
+{
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (names[i] == name)
+        {
+            return getColumn(i);
+        }
+    }
+    std::cerr << "There is no column " << name << " in " << path << std::endl;
+    return std::vector<double>();
+}
@@ -35,6 +35,10 @@
 #include "precision_handler.h"
 #include "StressProtocols/stress_protocol.h"
 #include "simulation.h"
+#include "quasistatic_loading.h"
+#include "relaxation.h"
+#include "binary_log.h"
+#include "trajectory.h"
 
 #include <memory>
 
@@ -123,6 +127,11 @@ def("get_cpu_time", &get_cpu_time);
             .value("EndOfFirstSmallStep", sdddstCore::StressProtocolStepType::EndOfFirstSmallStep)
             .value("EndOfSecondSmallStep", sdddstCore::StressProtocolStepType::EndOfSecondSmallStep);
 
+    enum_<sdddstCore::IntegratorType>("IntegratorType")
+            .value("TrapezoidalStepDoubling", sdddstCore::IntegratorType::TrapezoidalStepDoubling)
+            .value("TrapezoidalEmbedded", sdddstCore::IntegratorType::TrapezoidalEmbedded)
+            .value("RosenbrockW", sdddstCore::IntegratorType::RosenbrockW);
+
     class_<sdddstCore::StressProtocol, boost::noncopyable>("StressProtocol")
             .def("calculate_stress", &sdddstCore::StressProtocol::calculateStress)
             .def("get_stress", &sdddstCore::StressProtocol::getStress);
@@ -142,14 +151,15 @@ def("get_cpu_time", &get_cpu_time);
             .def("write_dislocation_data_to_file", &sdddstCore::SimulationData::writeDislocationDataToFile)
             .def("read_point_defect_data_from_file", &sdddstCore::SimulationData::readPointDefectDataFromFile)
             .def("write_point_defect_data_to_file", &sdddstCore::SimulationData::writePointDefectDataToFile)
+            .def("read_dislocation_data_from_trajectory", &sdddstCore::SimulationData::readDislocationDataFromTrajectory)
             .def("init_simulation_variables", &sdddstCore::SimulationData::initSimulationVariables)
             .def("update_cutoff", &sdddstCore::SimulationData::updateCutOff)
             .def_readwrite("dislocations", &sdddstCore::SimulationData::dislocations)
             .def_readwrite("point_defects", &sdddstCore::SimulationData::points)
-            .def_readwrite("g_vec", &sdddstCore::SimulationData::g)
+            .add_property("g_vec", make_function(&sdddstCore::SimulationData::getG, return_internal_reference<>()))
             .def_readwrite("init_speed", &sdddstCore::SimulationData::initSpeed)
             .def_readwrite("init_speed_2", &sdddstCore::SimulationData::initSpeed2)
-            .def_readwrite("d_vec", &sdddstCore::SimulationData::dVec)
+            .add_property("d_vec", make_function(&sdddstCore::SimulationData::getDVec, return_internal_reference<>()))
             .def_readwrite("cutoff_multiplier", &sdddstCore::SimulationData::cutOffMultiplier)
             .def_readwrite("cutoff", &sdddstCore::SimulationData::cutOff)
             .def_readwrite("cutoff_square", &sdddstCore::SimulationData::cutOffSqr)
@@ -158,6 +168,12 @@ def("get_cpu_time", &get_cpu_time);
             .def_readwrite("point_defect_count", &sdddstCore::SimulationData::pc)
             .def_readwrite("dislocation_count", &sdddstCore::SimulationData::dc)
             .def_readwrite("iteration_count", &sdddstCore::SimulationData::ic)
+            .def_readwrite("newton_convergence_controlled", &sdddstCore::SimulationData::isNewtonConvergenceControlled)
+            .def_readwrite("newton_tolerance", &sdddstCore::SimulationData::newtonTolerance)
+            .def_readwrite("min_iteration_count", &sdddstCore::SimulationData::minIterationCount)
+            .def_readwrite("max_iteration_count", &sdddstCore::SimulationData::maxIterationCount)
+            .def_readwrite("predictor_order", &sdddstCore::SimulationData::predictorOrder)
+            .def_readwrite("integrator", &sdddstCore::SimulationData::integrator)
             .def_readwrite("time_limit", &sdddstCore::SimulationData::timeLimit)
             .def_readwrite("step_size", &sdddstCore::SimulationData::stepSize)
             .def_readwrite("simulation_time", &sdddstCore::SimulationData::simTime)
@@ -176,8 +192,31 @@ def("get_cpu_time", &get_cpu_time);
             .def_readwrite("time_limited", &sdddstCore::SimulationData::isTimeLimit)
             .def_readwrite("step_count_limited", &sdddstCore::SimulationData::isStepCountLimit)
             .def_readwrite("step_count_limit", &sdddstCore::SimulationData::stepCountLimit)
+            .def_readwrite("concurrent_stages", &sdddstCore::SimulationData::concurrentStages)
+            .def_readwrite("reuse_half_step", &sdddstCore::SimulationData::reuseHalfStep)
+            .def_readonly("reused_half_steps", &sdddstCore::SimulationData::reusedHalfSteps)
+            .def_readwrite("multirate_max_substeps", &sdddstCore::SimulationData::multirateMaxSubsteps)
+            .def_readwrite("multirate_max_fast_ratio", &sdddstCore::SimulationData::multirateMaxFastRatio)
+            .def_readonly("multirate_steps", &sdddstCore::SimulationData::multirateSteps)
+            .def_readwrite("speculative_trials", &sdddstCore::SimulationData::speculativeTrials)
+            .def_readwrite("richardson_extrapolation", &sdddstCore::SimulationData::richardsonExtrapolation)
+            .def_readwrite("relaxation_force_tolerance", &sdddstCore::SimulationData::relaxationForceTolerance)
+            .def_readwrite("relaxation_max_iterations", &sdddstCore::SimulationData::relaxationMaxIterations)
+            .def_readwrite("aqs_stress_step", &sdddstCore::SimulationData::aqsStressStep)
+            .def_readwrite("aqs_avalanche_strain", &sdddstCore::SimulationData::aqsAvalancheStrain)
+            .def_readwrite("dipole_treatment", &sdddstCore::SimulationData::isDipoleTreatment)
+            .def_readwrite("dipole_distance", &sdddstCore::SimulationData::dipoleDistance)
+            .def_readonly("dipole_bindings", &sdddstCore::SimulationData::dipoleBindings)
+            .def_readonly("dipole_releases", &sdddstCore::SimulationData::dipoleReleases)
+            .def_readwrite("annihilation", &sdddstCore::SimulationData::isAnnihilation)
+            .def_readwrite("annihilation_distance", &sdddstCore::SimulationData::annihilationDistance)
+            .def_readonly("annihilations", &sdddstCore::SimulationData::annihilations)
+            .def_readonly("step_heap_allocations", &sdddstCore::SimulationData::stepHeapAllocations)
             .def_readwrite("calculate_strain_during_simulation", &sdddstCore::SimulationData::calculateStrainDuringSimulation)
             .def_readwrite("calculate_order_parameter", &sdddstCore::SimulationData::orderParameterCalculationIsOn)
+            .def_readwrite("log_step_interval", &sdddstCore::SimulationData::logStepInterval)
+            .def_readwrite("log_time_window", &sdddstCore::SimulationData::logTimeWindow)
+            .def_readwrite("log_full_during_avalanche", &sdddstCore::SimulationData::logFullDuringAvalanche)
             .def_readwrite("final_dislocation_configuration_path", &sdddstCore::SimulationData::endDislocationConfigurationPath)
             .def_readwrite("count_avalanches", &sdddstCore::SimulationData::countAvalanches)
             .def_readwrite("avalanche_speed_threshold", &sdddstCore::SimulationData::avalancheSpeedThreshold)
@@ -186,8 +225,18 @@ def("get_cpu_time", &get_cpu_time);
             .def_readwrite("in_avalanche", &sdddstCore::SimulationData::inAvalanche)
             .def_readwrite("save_sub_configs", &sdddstCore::SimulationData::isSaveSubConfigs)
             .def_readwrite("sub_config_path", &sdddstCore::SimulationData::subConfigPath)
+            .def_readwrite("trajectory_path", &sdddstCore::SimulationData::trajectoryPath)
+            .def_readwrite("trajectory_chunk_size", &sdddstCore::SimulationData::trajectoryChunkSize)
+            .def_readwrite("compress_trajectory", &sdddstCore::SimulationData::compressTrajectory)
+            .def_readwrite("delta_encode_trajectory", &sdddstCore::SimulationData::deltaEncodeTrajectory)
+            .def_readwrite("checkpoint_path", &sdddstCore::SimulationData::checkpointPath)
+            .def_readwrite("checkpoint_interval", &sdddstCore::SimulationData::checkpointInterval)
+            .def_readwrite("restart_path", &sdddstCore::SimulationData::restartPath)
             .def_readwrite("sub_config_delay", &sdddstCore::SimulationData::subConfigDelay)
             .def_readwrite("sub_config_delay_during_avalanche", &sdddstCore::SimulationData::subConfigDelayDuringAvalanche)
+            .def_readwrite("sub_config_queue_size", &sdddstCore::SimulationData::subConfigQueueSize)
+            .def_readonly("sub_config_queue_max_depth", &sdddstCore::SimulationData::subConfigQueueMaxDepth)
+            .def_readonly("sub_config_blocked_time", &sdddstCore::SimulationData::subConfigBlockedTime)
             .def_readwrite("sub_config_distance_counter", &sdddstCore::SimulationData::subconfigDistanceCounter)
             .def_readonly("stress_state", &sdddstCore::SimulationData::currentStressStateType)
             .add_property("tau", make_function(&sdddstCore::SimulationData::getField, return_internal_reference<>()), &sdddstCore::SimulationData::setField)
@@ -203,8 +252,40 @@ def("get_cpu_time", &get_cpu_time);
             .staticmethod("create")
             .def("run", &sdddstCore::Simulation::run)
             .def("step", &sdddstCore::Simulation::step)
+            .def("write_checkpoint", &sdddstCore::Simulation::writeCheckpoint)
+            .def("read_checkpoint", &sdddstCore::Simulation::readCheckpoint)
             .def("get_time", &sdddstCore::Simulation::getSimTime);
 
+    class_<sdddstCore::Relaxation, boost::noncopyable>("Relaxation", no_init)
+            .def("create", &sdddstCore::Relaxation::create, return_value_policy<manage_new_object>())
+            .staticmethod("create")
+            .def("run", &sdddstCore::Relaxation::run)
+            .def("step", &sdddstCore::Relaxation::step)
+            .def("get_max_force", &sdddstCore::Relaxation::getMaxForce)
+            .def("get_iteration_count", &sdddstCore::Relaxation::getIterationCount);
+
+    class_<sdddstCore::QuasistaticLoading, boost::noncopyable>("QuasistaticLoading", no_init)
+            .def("create", &sdddstCore::QuasistaticLoading::create, return_value_policy<manage_new_object>())
+            .staticmethod("create")
+            .def("run", &sdddstCore::QuasistaticLoading::run)
+            .def("step", &sdddstCore::QuasistaticLoading::step)
+            .def("get_stress", &sdddstCore::QuasistaticLoading::getStress);
+
+    class_<sdddstCore::TrajectoryReader, boost::noncopyable>("Trajectory", init<std::string>())
+            .def("update", &sdddstCore::TrajectoryReader::update)
+            .def("get_frame_count", &sdddstCore::TrajectoryReader::getFrameCount)
+            .def("get_time", &sdddstCore::TrajectoryReader::getTime)
+            .def("read_frame", &sdddstCore::TrajectoryReader::readFrame);
+
+    class_<sdddstCore::BinaryLogReader, boost::noncopyable>("BinaryLog", init<std::string>())
+            .def("get_column_names", &sdddstCore::BinaryLogReader::getColumnNames)
+            .def("get_row_count", &sdddstCore::BinaryLogReader::getRowCount)
+            .def("get_column", &sdddstCore::BinaryLogReader::getColumn)
+            .def("get_column_by_name", &sdddstCore::BinaryLogReader::getColumnByName);
+
+    class_<std::vector<std::string>>("StringVector")
+            .def(vector_indexing_suite<std::vector<std::string>>());
+
     class_<std::vector<double>>("DoubleVector")
             .def(vector_indexing_suite<std::vector<double>>());
 }
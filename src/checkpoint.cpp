@@ -0,0 +1,150 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "checkpoint.h"
+#include "constants.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <unistd.h>
+
+using namespace sdddstCore;
+
+namespace {
+
+volatile std::sig_atomic_t checkpointSignalReceived = 0;
+
+void checkpointSignalHandler(int)
+{
+    checkpointSignalReceived = 1;
+}
+
+}
+
+CheckpointWriter::CheckpointWriter(const std::string &path):
+    path(path),
+    temporaryPath(path + ".tmp"),
+    out(temporaryPath, std::ios::binary | std::ios::trunc)
+{
+    if (!out.is_open())
+    {
+        std::cerr << "Cannot open " << temporaryPath << " to write!" << std::endl;
+        exit(-1);
+    }
+    out.write(CHECKPOINT_FILE_MAGIC, 8);
+    write(uint32_t(CHECKPOINT_FILE_VERSION));
+}
+
+void CheckpointWriter::write(const std::string &value)
+{
+    write(uint64_t(value.size()));
+    out.write(value.data(), std::streamsize(value.size()));
+}
+
+void CheckpointWriter::commit()
+{
+    out.close();
+    if (out.fail() || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::cerr << "Cannot write the checkpoint " << path << std::endl;
+        exit(-1);
+    }
+}
+
+CheckpointReader::CheckpointReader(const std::string &path):
+    path(path),
+    in(path, std::ios::binary)
+{
+    char magic[8];
+    uint32_t version = 0;
+    in.read(magic, sizeof(magic));
+    check();
+    read(version);
+    if (memcmp(magic, CHECKPOINT_FILE_MAGIC, sizeof(magic)) != 0 || version != CHECKPOINT_FILE_VERSION)
+    {
+        std::cerr << path << " is not a supported checkpoint file!" << std::endl;
+        exit(-1);
+    }
+}
+
+void CheckpointReader::read(std::string &value)
+{
+    uint64_t size;
+    read(size);
+    value.resize(size);
+    in.read(&value[0], std::streamsize(size));
+    check();
+}
+
+void CheckpointReader::expect(const std::string &value)
+{
+    std::string stored;
+    read(stored);
+    if (stored != value)
+    {
+        std::cerr << "The checkpoint " << path << " was written with " << stored << " instead of " << value << "!" << std::endl;
+        exit(-1);
+    }
+}
+
+void CheckpointReader::check()
+{
+    if (!in)
+    {
+        std::cerr << "Cannot read the checkpoint " << path << std::endl;
+        exit(-1);
+    }
+}
+
+int64_t sdddstCore::getOutputFileSize(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open())
+    {
+        return -1;
+    }
+    return int64_t(in.tellg());
+}
+
+void sdddstCore::truncateOutputFile(const std::string &path, int64_t size)
+{
+    if (getOutputFileSize(path) < 0)
+    {
+        return;
+    }
+    if (truncate(path.c_str(), off_t(size > 0 ? size : 0)) != 0)
+    {
+        std::cerr << "Cannot truncate " << path << std::endl;
+        exit(-1);
+    }
+}
+
+void sdddstCore::installCheckpointSignalHandler()
+{
+    std::signal(SIGTERM, checkpointSignalHandler);
+}
+
+bool sdddstCore::isCheckpointSignalReceived()
+{
+    return checkpointSignalReceived != 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "configuration_file.h"
+#include "input_stream.h"
+#include "simulation_data.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+/**
+ * Converts a dislocation or point defect configuration file between the text and the binary format.
+ * The direction of the conversion is given by the format of the input file, the kind of a text file is
+ * recognised from the number of columns in its first line.
+ */
+int main(int argc, char ** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input configuration> <output configuration>" << std::endl;
+        return -1;
+    }
+    std::string input(argv[1]);
+    std::string output(argv[2]);
+
+    sdddstCore::SimulationData data;
+    if (sdddstCore::isBinaryConfigurationFile(input))
+    {
+        std::ifstream in(input, std::ios::binary);
+        sdddstCore::ConfigurationFileHeader header;
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (header.kind == sdddstCore::DislocationConfiguration)
+        {
+            data.readDislocationDataFromFile(input);
+            data.writeDislocationDataToFile(output);
+        }
+        else
+        {
+            data.readPointDefectDataFromFile(input);
+            data.writePointDefectDataToFile(output);
+        }
+        return 0;
+    }
+
+    // The text file can be compressed, it is read twice, so it can not be a pipe
+    sdddstCore::InputStream text(input);
+    std::istream & in = text.get();
+    std::string line;
+    while (line.find_first_not_of(" \t\r") == std::string::npos && std::getline(in, line));
+    std::istringstream firstLine(line);
+    unsigned int columns = 0;
+    std::string value;
+    while (firstLine >> value)
+    {
+        columns++;
+    }
+
+    if (columns == 3)
+    {
+        data.readDislocationDataFromFile(input);
+        sdddstCore::writeBinaryDislocationFile(output, data.dislocations);
+    }
+    else if (columns == 2)
+    {
+        data.readPointDefectDataFromFile(input);
+        sdddstCore::writeBinaryPointDefectFile(output, data.points);
+    }
+    else
+    {
+        std::cerr << "Unknown configuration file format: " << input << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
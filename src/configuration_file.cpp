@@ -0,0 +1,155 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "configuration_file.h"
+#include "constants.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace sdddstCore;
+
+namespace {
+
+template<typename T>
+void writeBinaryFile(const std::string & path, ConfigurationKind kind, const std::vector<T> & data, uint64_t columns,
+                     double (*get)(const T &, unsigned int))
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open())
+    {
+        std::cerr << "Cannot open " << path << " to write!" << std::endl;
+        exit(-1);
+    }
+
+    ConfigurationFileHeader header;
+    memcpy(header.magic, CONFIGURATION_FILE_MAGIC, sizeof(header.magic));
+    header.version = CONFIGURATION_FILE_VERSION;
+    header.kind = kind;
+    header.count = data.size();
+    header.columns = columns;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<double> column(data.size());
+    for (unsigned int c = 0; c < columns; c++)
+    {
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            column[i] = get(data[i], c);
+        }
+        out.write(reinterpret_cast<const char*>(column.data()), std::streamsize(column.size() * sizeof(double)));
+    }
+}
+
+double dislocationCoordinate(const Dislocation & d, unsigned int c)
+{
+    return c == 0 ? d.x : (c == 1 ? d.y : d.b);
+}
+
+double pointDefectCoordinate(const PointDefect & p, unsigned int c)
+{
+    return c == 0 ? p.x : p.y;
+}
+
+}
+
+bool sdddstCore::isBinaryConfigurationFile(const std::string &path)
+{
+    // A pipe is not checked, as the magic number could not be given back to it (and it can not be mapped)
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        return false;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    char magic[8];
+    if (!in.read(magic, sizeof(magic)))
+    {
+        return false;
+    }
+    return memcmp(magic, CONFIGURATION_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+MappedConfigurationFile::MappedConfigurationFile(const std::string &path, ConfigurationKind kind):
+    mapping(nullptr),
+    mappingSize(0),
+    header(nullptr)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        std::cerr << "Cannot open configuration file " << path << std::endl;
+        exit(-1);
+    }
+    mappingSize = size_t(st.st_size);
+    if (mappingSize >= sizeof(ConfigurationFileHeader))
+    {
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapping == nullptr || mapping == MAP_FAILED)
+    {
+        std::cerr << "Cannot map configuration file " << path << std::endl;
+        exit(-1);
+    }
+    header = static_cast<const ConfigurationFileHeader*>(mapping);
+
+    uint64_t expectedColumns = (kind == DislocationConfiguration ? 3 : 2);
+    if (header->version != CONFIGURATION_FILE_VERSION || header->kind != uint32_t(kind) ||
+            header->columns != expectedColumns ||
+            (mappingSize - sizeof(ConfigurationFileHeader)) / sizeof(double) / expectedColumns < header->count)
+    {
+        std::cerr << "Invalid or unsupported binary configuration file " << path << std::endl;
+        exit(-1);
+    }
+}
+
+MappedConfigurationFile::~MappedConfigurationFile()
+{
+    munmap(mapping, mappingSize);
+}
+
+uint64_t MappedConfigurationFile::getCount() const
+{
+    return header->count;
+}
+
+const double *MappedConfigurationFile::getColumn(unsigned int i) const
+{
+    return reinterpret_cast<const double*>(header + 1) + header->count * i;
+}
+
+void sdddstCore::writeBinaryDislocationFile(const std::string &path, const std::vector<Dislocation> &dislocations)
+{
+    writeBinaryFile(path, DislocationConfiguration, dislocations, 3, dislocationCoordinate);
+}
+
+void sdddstCore::writeBinaryPointDefectFile(const std::string &path, const std::vector<PointDefect> &points)
+{
+    writeBinaryFile(path, PointDefectConfiguration, points, 2, pointDefectCoordinate);
+}
@@ -1,13 +1,27 @@
 #include "data_time_series.h"
 #include "constants.h"
+#include "input_stream.h"
 
-#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
 #include <cmath>
+#include <limits>
 
 DataTimeSeries::DataTimeSeries(std::string dconfList, std::string fconf):
-    fconfPath(fconf)
+    fconfPath(fconf),
+    nextFrame(0),
+    startTime(-std::numeric_limits<double>::infinity()),
+    endTime(std::numeric_limits<double>::infinity()),
+    stride(1)
 {
-    std::ifstream dcs(dconfList);
+    if (sdddstCore::isTrajectoryFile(dconfList)) {
+        trajectory.reset(new sdddstCore::TrajectoryReader(dconfList));
+        return;
+    }
+
+    sdddstCore::InputStream input(dconfList);
+    std::istream & dcs = input.get();
     while (!dcs.eof()) {
         std::string tmp;
         dcs >> tmp;
@@ -18,25 +32,89 @@ DataTimeSeries::DataTimeSeries(std::string dconfList, std::string fconf):
         dcs >> path;
         dconfs.push_back(std::make_pair(std::stod(tmp), path));
     }
+    if (dcs.bad()) {
+        std::cerr << "Cannot read " << dconfList << std::endl;
+        exit(-1);
+    }
+}
+
+void DataTimeSeries::setTimeRange(double startTime, double endTime)
+{
+    if (!trajectory && !std::is_sorted(dconfs.begin(), dconfs.end(),
+                                       [](const std::pair<double, std::string> & a, const std::pair<double, std::string> & b) { return a.first < b.first; })) {
+        std::cerr << "The times of the file list have to be increasing to select a time range!" << std::endl;
+        exit(-1);
+    }
+    this->startTime = startTime;
+    this->endTime = endTime;
+}
+
+void DataTimeSeries::setStride(size_t stride)
+{
+    this->stride = stride > 0 ? stride : 1;
 }
 
 bool DataTimeSeries::next(std::shared_ptr<sdddstCore::SimulationData> sD)
 {
-    if (dconfs.size() == 0) {
+    if (!findNextFrame()) {
         return false;
     }
 
-    auto pair = dconfs.front();
-
-    sD->readDislocationDataFromFile(pair.second);
+    if (trajectory) {
+        sD->readDislocationDataFromTrajectory(*trajectory, nextFrame);
+    } else {
+        sD->readDislocationDataFromFile(dconfs[nextFrame].second);
+    }
     sD->readPointDefectDataFromFile(fconfPath);
 
     sD->A = DEFAULT_A * 1./sqrt(sD->dc);
     sD->KASQR = DEFAULT_KASQR * double(sD->dc);
 
-    sD->simTime = pair.first;
+    sD->simTime = getTime(nextFrame);
 
-    dconfs.pop_front();
+    nextFrame += stride;
 
     return true;
 }
+
+size_t DataTimeSeries::getFrameCount() const
+{
+    return trajectory ? trajectory->getFrameCount() : dconfs.size();
+}
+
+double DataTimeSeries::getTime(size_t frame) const
+{
+    return trajectory ? trajectory->getTime(frame) : dconfs[frame].first;
+}
+
+bool DataTimeSeries::findNextFrame()
+{
+    // The frames appended to the trajectory since the last check are indexed as well
+    if (nextFrame >= getFrameCount() && !(trajectory && trajectory->update() > 0 && nextFrame < getFrameCount())) {
+        return false;
+    }
+
+    // Only the index is searched, the skipped frames are not read
+    if (getTime(nextFrame) < startTime) {
+        nextFrame = findFrame(startTime, nextFrame);
+        if (nextFrame == getFrameCount()) {
+            return false;
+        }
+    }
+
+    return getTime(nextFrame) <= endTime;
+}
+
+size_t DataTimeSeries::findFrame(double time, size_t first) const
+{
+    size_t last = getFrameCount();
+    while (first < last) {
+        size_t middle = first + (last - first) / 2;
+        if (getTime(middle) < time) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return first;
+}
@@ -0,0 +1,118 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "input_stream.h"
+
+#include <boost/iostreams/filter/gzip.hpp>
+#ifdef SDDDST_ZSTD_INPUT
+#include <boost/iostreams/filter/zstd.hpp>
+#endif
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace sdddstCore;
+
+namespace {
+
+const char GZIP_MAGIC[] = {'\x1f', '\x8b'};
+const char ZSTD_MAGIC[] = {'\x28', '\xb5', '\x2f', '\xfd'};
+
+/**
+ * The bytes read to recognise the compression are given back before the rest of the input, so the input is never rewound
+ */
+class PrefixedSource
+{
+public:
+    typedef char char_type;
+    typedef boost::iostreams::source_tag category;
+
+    PrefixedSource(std::istream & rest, const std::string & prefix):
+        rest(&rest),
+        prefix(prefix),
+        position(0)
+    {
+    }
+
+    std::streamsize read(char * s, std::streamsize n)
+    {
+        std::streamsize count = 0;
+        while (count < n && position < prefix.size())
+        {
+            s[count++] = prefix[position++];
+        }
+        if (count < n && rest->good())
+        {
+            rest->read(s + count, n - count);
+            count += rest->gcount();
+        }
+        return count > 0 ? count : -1;
+    }
+
+private:
+    std::istream * rest;
+    std::string prefix;
+    size_t position;
+};
+
+bool startsWith(const std::string & data, const char * magic, size_t size)
+{
+    return data.size() >= size && data.compare(0, size, magic, size) == 0;
+}
+
+}
+
+InputStream::InputStream(const std::string &path)
+{
+    std::istream * source = &std::cin;
+    if (path != "-")
+    {
+        file.open(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Cannot open " << path << " to read!" << std::endl;
+            exit(-1);
+        }
+        source = &file;
+    }
+
+    char magic[sizeof(ZSTD_MAGIC)];
+    source->read(magic, sizeof(magic));
+    std::string prefix(magic, size_t(source->gcount()));
+
+    if (startsWith(prefix, GZIP_MAGIC, sizeof(GZIP_MAGIC)))
+    {
+        stream.push(boost::iostreams::gzip_decompressor());
+    }
+    else if (startsWith(prefix, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)))
+    {
+#ifdef SDDDST_ZSTD_INPUT
+        stream.push(boost::iostreams::zstd_decompressor());
+#else
+        std::cerr << path << " is compressed with zstd, but it is not supported by this build (it needs Boost.Iostreams 1.67 or later built with zstd)!" << std::endl;
+        exit(-1);
+#endif
+    }
+    stream.push(PrefixedSource(*source, prefix));
+}
+
+std::istream &InputStream::get()
+{
+    return stream;
+}
@@ -0,0 +1,98 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "integrator_workspace.h"
+
+#include <cassert>
+#include <cstdlib>
+
+using namespace sdddstCore;
+
+IntegratorWorkspace::IntegratorWorkspace():
+    Ap(nullptr),
+    Ai(nullptr),
+    Ax(nullptr),
+    x(nullptr),
+    null(NULL),
+    Symbolic(nullptr),
+    Numeric(nullptr),
+    currentStorageSize(0),
+    iterationCount(0),
+    newtonFailed(false),
+    stressIsValid(false),
+    stressTime(0),
+    stressStrain(0)
+{
+    // Nothing to do
+}
+
+IntegratorWorkspace::~IntegratorWorkspace()
+{
+    release();
+}
+
+void IntegratorWorkspace::resize(unsigned int dc)
+{
+    release();
+    currentStorageSize = dc;
+    g.resize(dc);
+    speed.resize(dc);
+    dVec.resize(dc);
+    Ap = (int*) calloc(dc+1, sizeof(int));
+    Ai = (int*) calloc(dc*dc, sizeof(int));
+    Ax = (double*) calloc(dc, sizeof(double));
+    x = (double*) calloc(dc, sizeof(double));
+    assert(Ap && "Memory allication for Ap failed!");
+    assert(Ai && "Memory allocation for Ai failed!");
+    assert(Ax && "Memory allocation for Ax failed!");
+    assert(x && "Memory allocation for x failed!");
+    indexes.resize(dc);
+    tolerance.setSize(dc);
+}
+
+void IntegratorWorkspace::shrink(unsigned int dc)
+{
+    g.resize(dc);
+    speed.resize(dc);
+    dVec.resize(dc);
+    for (auto & stage: stages)
+    {
+        stage.resize(dc);
+    }
+    indexes.resize(dc);
+    tolerance.setSize(dc);
+}
+
+void IntegratorWorkspace::release()
+{
+    currentStorageSize = 0;
+    g.resize(0);
+    speed.resize(0);
+    dVec.resize(0);
+    stages.resize(0);
+    free(Ap);
+    Ap = nullptr;
+    free(Ai);
+    Ai = nullptr;
+    free(Ax);
+    Ax = nullptr;
+    free(x);
+    x = nullptr;
+    indexes.resize(0);
+}
@@ -0,0 +1,191 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "log_aggregator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace sdddstCore;
+
+LogAggregator::LogAggregator(unsigned int stepInterval, double timeWindow, bool fullDuringAvalanche, double avalancheSpeedThreshold):
+    stepInterval(stepInterval),
+    timeWindow(timeWindow),
+    fullDuringAvalanche(fullDuringAvalanche),
+    avalancheSpeedThreshold(avalancheSpeedThreshold),
+    inAvalanche(false),
+    columns(0),
+    windowRows(0),
+    windowEnd(NAN)
+{
+}
+
+void LogAggregator::setColumnCount(size_t columns)
+{
+    this->columns = columns;
+    window.resize(3 * columns);
+    output.resize(3 * columns);
+    resetWindow();
+}
+
+bool LogAggregator::isWindowed() const
+{
+    return timeWindow > 0;
+}
+
+size_t LogAggregator::getOutputColumnCount() const
+{
+    return isWindowed() ? 3 * columns : columns;
+}
+
+std::vector<std::string> LogAggregator::getColumnNames(const std::vector<std::string> &names) const
+{
+    if (!isWindowed())
+    {
+        return names;
+    }
+
+    std::vector<std::string> result;
+    for (auto & name: names)
+    {
+        result.push_back(name + "_min");
+        result.push_back(name + "_mean");
+        result.push_back(name + "_max");
+    }
+    return result;
+}
+
+const double *LogAggregator::addInitialRow(const double *row)
+{
+    if (!isWindowed())
+    {
+        return row;
+    }
+    addToWindow(row);
+    return closeWindow();
+}
+
+const double *LogAggregator::addStep(const double *row, size_t step, double time, double averageSpeed)
+{
+    // The same detection as the avalanche limit uses, but it does not change the avalanche state of the simulation
+    if (fullDuringAvalanche)
+    {
+        if (inAvalanche && averageSpeed < avalancheSpeedThreshold)
+        {
+            inAvalanche = false;
+        }
+        else if (averageSpeed > avalancheSpeedThreshold)
+        {
+            inAvalanche = true;
+        }
+    }
+
+    if (!isWindowed())
+    {
+        if ((fullDuringAvalanche && inAvalanche) || (stepInterval > 0 && step % stepInterval == 0))
+        {
+            return row;
+        }
+        return nullptr;
+    }
+
+    // The windows end at the multiples of their length, the empty ones are skipped
+    if (!(windowEnd == windowEnd))
+    {
+        windowEnd = timeWindow * (std::floor(time / timeWindow) + 1);
+    }
+
+    addToWindow(row);
+    if (time < windowEnd && !(fullDuringAvalanche && inAvalanche))
+    {
+        return nullptr;
+    }
+
+    windowEnd = timeWindow * (std::floor(time / timeWindow) + 1);
+    return closeWindow();
+}
+
+const double *LogAggregator::finish()
+{
+    if (!isWindowed() || windowRows == 0)
+    {
+        return nullptr;
+    }
+    return closeWindow();
+}
+
+void LogAggregator::writeCheckpoint(CheckpointWriter &writer) const
+{
+    writer.write(window);
+    writer.write(windowRows);
+    writer.write(windowEnd);
+    writer.write(inAvalanche);
+}
+
+void LogAggregator::readCheckpoint(CheckpointReader &reader)
+{
+    reader.read(window);
+    reader.read(windowRows);
+    reader.read(windowEnd);
+    reader.read(inAvalanche);
+}
+
+void LogAggregator::resetWindow()
+{
+    for (size_t i = 0; i < columns; i++)
+    {
+        window[3 * i] = std::numeric_limits<double>::infinity();
+        window[3 * i + 1] = 0;
+        window[3 * i + 2] = -std::numeric_limits<double>::infinity();
+    }
+    windowRows = 0;
+}
+
+void LogAggregator::addToWindow(const double *row)
+{
+    // A missing value (NaN) is kept in all three columns
+    for (size_t i = 0; i < columns; i++)
+    {
+        if (row[i] == row[i])
+        {
+            window[3 * i] = std::min(window[3 * i], row[i]);
+            window[3 * i + 2] = std::max(window[3 * i + 2], row[i]);
+        }
+        else
+        {
+            window[3 * i] = NAN;
+            window[3 * i + 2] = NAN;
+        }
+        window[3 * i + 1] += row[i];
+    }
+    windowRows++;
+}
+
+const double *LogAggregator::closeWindow()
+{
+    for (size_t i = 0; i < columns; i++)
+    {
+        output[3 * i] = window[3 * i];
+        output[3 * i + 1] = window[3 * i + 1] / double(windowRows);
+        output[3 * i + 2] = window[3 * i + 2];
+    }
+    resetWindow();
+    return output.data();
+}
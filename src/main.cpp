@@ -18,6 +18,8 @@
  */
 
 #include "project_parser.h"
+#include "quasistatic_loading.h"
+#include "relaxation.h"
 #include "simulation.h"
 #include "time_series_processor.h"
 
@@ -34,6 +36,22 @@ int main(int argc, char ** argv)
         // Run the simulation
         simulation.run();
 
+    } else if (parser.getPType() == sdddstCore::RELAXATION) {
+
+        // Init the minimizer
+        sdddstCore::Relaxation relaxation(parser.getSimulationData());
+
+        // Relax the configuration
+        relaxation.run();
+
+    } else if (parser.getPType() == sdddstCore::QUASISTATIC_LOADING) {
+
+        // Init the loading driver
+        sdddstCore::QuasistaticLoading loading(parser.getSimulationData());
+
+        // Load until the limits
+        loading.run();
+
     } else if (parser.getPType() == sdddstCore::EV_ANALYZATION) {
         // Init processor
         sdddstEV::TimeSeriesProcessor processor(parser.getSimulationData(), parser.getDataTimeSeries(), parser.getStressProtocol());
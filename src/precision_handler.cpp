@@ -19,6 +19,7 @@
 
 #include "constants.h"
 #include "precision_handler.h"
+#include "StepSizeControllers/step_size_controller.h"
 
 #include <cmath>
 #include <iostream>
@@ -100,22 +101,21 @@ void PrecisionHandler::updateError(const double &error, const unsigned int &ID)
     }
 }
 
-double PrecisionHandler::getNewStepSize(const double &oldStepSize) const
+void PrecisionHandler::mergeTolerance(const PrecisionHandler &other)
 {
-    if(0.0 == maxErrorRatioSqr)
+    for (size_t i = 0; i < toleranceAndError.size() && i < other.toleranceAndError.size(); i++)
     {
-        return oldStepSize * 2.0;
-    }
-
-    double tmp = 1./sqrt(maxErrorRatioSqr);
-
-    tmp = pow(tmp, 1./3.);
-    if (tmp > 2.0)
-    {
-        tmp = 2.0;
+        if (other.toleranceAndError[i].first < toleranceAndError[i].first)
+        {
+            toleranceAndError[i].first = other.toleranceAndError[i].first;
+        }
     }
+}
 
-    return 0.9 * oldStepSize * tmp;
+double PrecisionHandler::getNewStepSize(const double &oldStepSize) const
+{
+    // The simulation uses the step size controllers, this is the elementary one for the current error
+    return StepSizeController().getNewStepSize(oldStepSize, maxErrorRatioSqr, true);
 }
 
 double PrecisionHandler::getMinPrecisity() const
@@ -134,6 +134,32 @@ double PrecisionHandler::getMaxErrorRatioSqr() const
     return maxErrorRatioSqr;
 }
 
+double PrecisionHandler::getErrorRatioSqr(const unsigned int &ID) const
+{
+    return toleranceAndError[ID].second * toleranceAndError[ID].second / toleranceAndError[ID].first;
+}
+
+double PrecisionHandler::getToleranceSqr(const unsigned int &ID) const
+{
+    return toleranceAndError[ID].first;
+}
+
+void PrecisionHandler::clearError(const unsigned int &ID)
+{
+    toleranceAndError[ID].second = 0;
+    maxErrorRatioSqr = 0;
+    selectedID = 0;
+    for (unsigned int i = 0; i < toleranceAndError.size(); i++)
+    {
+        double tmp = getErrorRatioSqr(i);
+        if (tmp > maxErrorRatioSqr)
+        {
+            maxErrorRatioSqr = tmp;
+            selectedID = i;
+        }
+    }
+}
+
 #ifdef BUILD_PYTHON_BINDINGS
 
 std::string PrecisionHandler::__str__() const
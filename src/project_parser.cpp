@@ -17,14 +17,17 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
  */
 
+#include "checkpoint.h"
 #include "constants.h"
 #include "project_parser.h"
 #include "Fields/AnalyticField.h"
+#include "StepSizeControllers/pid_controller.h"
 #include "StressProtocols/stress_protocol.h"
 #include "StressProtocols/fixed_rate_protocol.h"
 #include "StressProtocols/spring_protocol.h"
 
 #include <iostream>
+#include <limits>
 
 sdddstCore::ProjectParser::ProjectParser(int argc, char **argv):
     sD(nullptr),
@@ -38,7 +41,9 @@ sdddstCore::ProjectParser::ProjectParser(int argc, char **argv):
 
     operationModeOptions.add_options()
             ("simulation", "run a simulation (default)")
-            ("ev-analyzation", "run eigen value analysation");
+            ("ev-analyzation", "run eigen value analysation")
+            ("relaxation", "relax the configuration with the FIRE energy minimizer at the initial external stress instead of simulating the dynamics")
+            ("quasistatic-loading", "athermal quasistatic loading: the fixed rate external stress is raised towards the predicted next instability and the configuration is relaxed after every increment");
 
     requiredOptions.add_options()
             ("dislocation-configuration", boost::program_options::value<std::string>(), "plain text file path containing dislocation data in {x y b} triplets")
@@ -48,6 +53,10 @@ sdddstCore::ProjectParser::ProjectParser(int argc, char **argv):
     optionalOptions.add_options()
             ("point-defect-configuration", boost::program_options::value<std::string>(), "plain text file path containing point defect data in {x y} pairs")
             ("logfile-path", boost::program_options::value<std::string>(), "path for the plain text log file (it will be overwritten if it already exists)")
+            ("binary-log", "the log file is written with binary columns on a background thread instead of text (only in simulation mode)")
+            ("log-step-interval", boost::program_options::value<unsigned int>(), "only every N-th successful step is written into the log (only in simulation mode)")
+            ("log-time-window", boost::program_options::value<double>(), "the log contains the minimum, mean and maximum of every column in windows of the given simulation time (only in simulation mode)")
+            ("log-full-during-avalanche", "every step of the avalanches is written into the log, only these steps if there is no other selection (the avalanches are detected with avalanche-speed-threshold, the avalanche counting is not changed)")
             ("time-limit", boost::program_options::value<double>(), "in simulation time limit, if reached the simulation stops")
             ("speed-limit", boost::program_options::value<double>(), "in simulation units, if |v| falls below, the simulation stops")
             ("step-count-limit", boost::program_options::value<unsigned int>(), "the simulation will stop after successful N steps")
@@ -64,8 +73,38 @@ sdddstCore::ProjectParser::ProjectParser(int argc, char **argv):
             ("save-sub-configurations", boost::program_options::value<std::string>(), "saves the current configuration after every N successful step to the given destination")
             ("sub-configuration-delay", boost::program_options::value<unsigned int>()->default_value(5), "number of successful steps between the sub configurations written out")
             ("sub-configuration-delay-during-avalanche", boost::program_options::value<unsigned int>()->default_value(1), "number of successful steps between the sub configurations written out during avalanche if avalanche detection is on")
+            ("save-trajectory", boost::program_options::value<std::string>(), "writes the sub configurations into the given trajectory file instead of separate files (same delays as save-sub-configurations)")
+            ("trajectory-chunk-size", boost::program_options::value<unsigned int>()->default_value(DEFAULT_TRAJECTORY_CHUNK_SIZE), "number of frames written at once into the trajectory file")
+            ("compress-trajectory", "compresses the chunks of the trajectory file with zlib")
+            ("delta-encode-trajectory", "stores the x coordinates in the trajectory as differences to the previous frame quantised with the position precision (the chunks start with a full frame and are compressed)")
+            ("sub-configuration-queue-size", boost::program_options::value<unsigned int>()->default_value(DEFAULT_SUB_CONFIG_QUEUE_SIZE), "number of sub configurations which can wait for the background writer before the simulation waits for it")
+            ("checkpoint", boost::program_options::value<std::string>(), "the state of the simulation is saved into the given file periodically and on SIGTERM (the simulation stops after it)")
+            ("checkpoint-interval", boost::program_options::value<unsigned int>()->default_value(0), "number of successful steps between two checkpoints, 0 - only on SIGTERM")
+            ("restart-from", boost::program_options::value<std::string>(), "continues the simulation from the given checkpoint, the other options must be the same as in the original run (the output written after the checkpoint is dropped)")
             ("change-cutoff-to-inf-under-threshold", boost::program_options::value<double>(), "if the avg speed decreases once under this threshold during the simulation the applied cutoff multiplier will be 1e20")
             ("post-relax", boost::program_options::value<unsigned int>()->default_value(0), "Number of extra steps after finish condition is reached")
+            ("concurrent-stages", "integrates the big step and the first small step on separate threads (only with the trapezoidal integrator)")
+            ("newton-tolerance", boost::program_options::value<double>(), "the NR iteration stops if the largest correction is below arg * position-precision instead of doing a fixed number of iterations")
+            ("min-iteration-count", boost::program_options::value<unsigned int>()->default_value(DEFAULT_MIN_ITERATION_COUNT), "minimum number of NR iterations if newton-tolerance is set")
+            ("max-iteration-count", boost::program_options::value<unsigned int>()->default_value(DEFAULT_MAX_ITERATION_COUNT), "maximum number of NR iterations if newton-tolerance is set, the step is rejected if it is not converged")
+            ("predictor-order", boost::program_options::value<unsigned int>()->default_value(0), "order of the explicit predictor used as NR initial guess: 0 - old positions, 1 - Euler step with the initial speeds, 2 - with acceleration estimated from the speed history (only with the trapezoidal integrator)")
+            ("integrator", boost::program_options::value<std::string>()->default_value("trapezoidal"), "integration scheme: trapezoidal - damped trapezoidal rule with step doubling error estimate, "
+                                                                                                       "trapezoidal-embedded - one implicit step per attempt, the error is estimated from the difference to an explicit second order predictor, "
+                                                                                                       "ros34pw2 - third order Rosenbrock-W method with one Jacobian per step")
+            ("richardson-extrapolation", "the accepted steps of the trapezoidal step doubling are extrapolated from the big step and the two half steps for the dislocations where the rule is not damped, the error of the half steps is used for the step size control")
+            ("reuse-half-step", "after a rejected step the step size is halved if it would be at least the half of it and the first small step is reused as the next big step (only with the trapezoidal integrator)")
+            ("multirate-max-substeps", boost::program_options::value<unsigned int>(), "turns on multirate stepping: if only a few dislocations miss the precision they are integrated with at most arg substeps while the others keep the large step (only with the trapezoidal integrator)")
+            ("multirate-max-fast-ratio", boost::program_options::value<double>()->default_value(DEFAULT_MULTIRATE_MAX_FAST_RATIO), "maximum ratio of the dislocations which can be integrated with substeps in multirate mode")
+            ("step-size-controller", boost::program_options::value<std::string>()->default_value("elementary"), "step size controller: elementary - depends only on the error of the current attempt, "
+                                                                                                                 "pi - Gustafsson's PI controller using the error of the previous accepted step as well, "
+                                                                                                                 "pid - PID controller using the errors of the last two accepted steps")
+            ("speculative-trials", boost::program_options::value<unsigned int>(), "the step is tried with arg step sizes (the current one and its halves) at the same time on separate threads and the largest accepted one is used, only with the trapezoidal integrator")
+            ("relaxation-force-tolerance", boost::program_options::value<double>()->default_value(DEFAULT_RELAXATION_FORCE_TOLERANCE), "the relaxation stops if the largest force (speed) is below arg")
+            ("relaxation-max-iterations", boost::program_options::value<unsigned int>()->default_value(DEFAULT_RELAXATION_MAX_ITERATIONS), "the relaxation stops after arg iterations even if the force tolerance is not reached")
+            ("annihilation-distance", boost::program_options::value<double>(), "dislocations with opposite Burgers vectors closer than arg are annihilated (removed from the system) after the successful steps")
+            ("aqs-stress-step", boost::program_options::value<double>()->default_value(DEFAULT_AQS_STRESS_STEP), "largest stress increment of the quasistatic loading, the instabilities are approached with smaller ones")
+            ("aqs-avalanche-strain", boost::program_options::value<double>()->default_value(DEFAULT_AQS_AVALANCHE_STRAIN), "an instability of the quasistatic loading is counted as an avalanche if the strain of the relaxation beyond the linear response is above arg")
+            ("dipole-distance", boost::program_options::value<double>(), ("dislocations with opposite Burgers vectors closer than arg are treated as bound dipoles and integrated separately with substeps (at most multirate-max-substeps, " + std::to_string(DEFAULT_MULTIRATE_MAX_SUBSTEPS) + " if not set), only with the trapezoidal integrator").c_str())
             ;
 
     fieldOptions.add_options()
@@ -80,8 +119,11 @@ sdddstCore::ProjectParser::ProjectParser(int argc, char **argv):
 
     boost::program_options::options_description ev_options("EV analysis related options");
     ev_options.add_options()
-            ("file-list", boost::program_options::value<std::string>(), "file list with timestamps int timestamp file_path format")
+            ("file-list", boost::program_options::value<std::string>(), "file list with timestamps int timestamp file_path format or a trajectory file")
             ("pd-configuration", boost::program_options::value<std::string>(), "file path to the point defect config file")
+            ("ev-start-time", boost::program_options::value<double>(), "only the frames from the given time are analysed (the first one is searched in the index, the skipped frames are not read)")
+            ("ev-end-time", boost::program_options::value<double>(), "only the frames until the given time are analysed")
+            ("ev-frame-stride", boost::program_options::value<unsigned int>()->default_value(1), "only every N-th frame of the time range is analysed")
             ("result-ev-file", boost::program_options::value<std::string>(), "file path where to save result")
             ("calculate-ev-deriv", "use to turn on EV derivative calculation (analytic)")
             ("eigenvector-to-write", boost::program_options::value<int>()->default_value(10), "number of eigenvectors to write into file")
@@ -139,6 +181,24 @@ void sdddstCore::ProjectParser::processInput(boost::program_options::variables_m
     if (0 == vm.count("ev-analyzation"))
     {
         pType = SIMULATION;
+        if (vm.count("simulation") + vm.count("relaxation") + vm.count("quasistatic-loading") > 1)
+        {
+            std::cerr << "Only one operation mode can be selected!\n";
+            exit(-1);
+        }
+        if (vm.count("relaxation"))
+        {
+            pType = RELAXATION;
+        }
+        else if (vm.count("quasistatic-loading"))
+        {
+            if (0 == vm.count("fixed-rate-external-stress") || vm.count("spring-constant"))
+            {
+                std::cerr << "Quasistatic loading needs fixed-rate-external-stress without spring-constant!\n";
+                exit(-1);
+            }
+            pType = QUASISTATIC_LOADING;
+        }
         // Check for required options
         if (0 == vm.count("dislocation-configuration"))
         {
@@ -221,7 +281,52 @@ void sdddstCore::ProjectParser::processInput(boost::program_options::variables_m
             sD->orderParameterCalculationIsOn = true;
         }
 
-        if (vm.count("logfile-path"))
+        if ((vm.count("checkpoint") || vm.count("restart-from")) && (vm.count("relaxation") || vm.count("quasistatic-loading")))
+        {
+            std::cerr << "checkpoint and restart-from can be used only in simulation mode!\n";
+            exit(-1);
+        }
+
+        if (vm.count("checkpoint"))
+        {
+            sD->checkpointPath = vm["checkpoint"].as<std::string>();
+            sD->checkpointInterval = vm["checkpoint-interval"].as<unsigned int>();
+        }
+
+        if (vm.count("restart-from"))
+        {
+            // The output written after the checkpoint is dropped, the files are continued from there
+            sD->restartPath = vm["restart-from"].as<std::string>();
+            CheckpointReader reader(sD->restartPath);
+            int64_t logSize;
+            int64_t trajectorySize;
+            reader.read(logSize);
+            reader.read(trajectorySize);
+            if (vm.count("logfile-path"))
+            {
+                truncateOutputFile(vm["logfile-path"].as<std::string>(), logSize);
+            }
+            if (vm.count("save-trajectory"))
+            {
+                truncateOutputFile(vm["save-trajectory"].as<std::string>(), trajectorySize);
+            }
+        }
+
+        if (vm.count("binary-log") && (0 == vm.count("logfile-path") || vm.count("relaxation") || vm.count("quasistatic-loading")))
+        {
+            std::cerr << "binary-log needs logfile-path and it can be used only in simulation mode!\n";
+            exit(-1);
+        }
+
+        if (vm.count("binary-log"))
+        {
+            sD->binaryLog.reset(new BinaryLog(vm["logfile-path"].as<std::string>(), !sD->restartPath.empty()));
+        }
+        else if (vm.count("logfile-path") && !sD->restartPath.empty())
+        {
+            sD->standardOutputLog = std::ofstream(vm["logfile-path"].as<std::string>(), std::ios::app | std::ios::ate);
+        }
+        else if (vm.count("logfile-path"))
         {
             sD->standardOutputLog = std::ofstream(vm["logfile-path"].as<std::string>());
         }
@@ -239,12 +344,79 @@ void sdddstCore::ProjectParser::processInput(boost::program_options::variables_m
             sD->avalancheSpeedThreshold = vm["avalanche-speed-threshold"].as<double>();
         }
 
-        if (vm.count("save-sub-configurations"))
+        if ((vm.count("log-step-interval") || vm.count("log-time-window") || vm.count("log-full-during-avalanche")) &&
+                (vm.count("relaxation") || vm.count("quasistatic-loading")))
+        {
+            std::cerr << "log-step-interval, log-time-window and log-full-during-avalanche can be used only in simulation mode!\n";
+            exit(-1);
+        }
+
+        if (vm.count("log-step-interval") && vm.count("log-time-window"))
+        {
+            std::cerr << "Only one of log-step-interval and log-time-window can be used!\n";
+            exit(-1);
+        }
+
+        if (vm.count("log-step-interval"))
+        {
+            sD->logStepInterval = vm["log-step-interval"].as<unsigned int>();
+            if (sD->logStepInterval == 0)
+            {
+                std::cerr << "The log step interval must be at least 1!\n";
+                exit(-1);
+            }
+        }
+
+        if (vm.count("log-time-window"))
+        {
+            sD->logTimeWindow = vm["log-time-window"].as<double>();
+            if (!(sD->logTimeWindow > 0))
+            {
+                std::cerr << "The log time window must be positive!\n";
+                exit(-1);
+            }
+        }
+
+        if (vm.count("log-full-during-avalanche"))
+        {
+            sD->logFullDuringAvalanche = true;
+            // The log detects the avalanches itself, the avalanche counting (and the sub-configuration delay) is not turned on
+            sD->avalancheSpeedThreshold = vm["avalanche-speed-threshold"].as<double>();
+        }
+
+        if (vm.count("save-sub-configurations") && vm.count("save-trajectory"))
+        {
+            std::cerr << "Only one of save-sub-configurations and save-trajectory can be used!\n";
+            exit(-1);
+        }
+
+        if (vm.count("save-sub-configurations") || vm.count("save-trajectory"))
         {
             sD->isSaveSubConfigs = true;
-            sD->subConfigPath = vm["save-sub-configurations"].as<std::string>();
+            if (vm.count("save-sub-configurations"))
+            {
+                sD->subConfigPath = vm["save-sub-configurations"].as<std::string>();
+            }
+            else
+            {
+                sD->trajectoryPath = vm["save-trajectory"].as<std::string>();
+                sD->trajectoryChunkSize = vm["trajectory-chunk-size"].as<unsigned int>();
+                sD->compressTrajectory = vm.count("compress-trajectory") > 0;
+                sD->deltaEncodeTrajectory = vm.count("delta-encode-trajectory") > 0;
+                if (sD->trajectoryChunkSize == 0)
+                {
+                    std::cerr << "The trajectory chunk size must be at least 1!\n";
+                    exit(-1);
+                }
+            }
             sD->subConfigDelay = vm["sub-configuration-delay"].as<unsigned int>();
             sD->subConfigDelayDuringAvalanche = vm["sub-configuration-delay-during-avalanche"].as<unsigned int>();
+            sD->subConfigQueueSize = vm["sub-configuration-queue-size"].as<unsigned int>();
+            if (sD->subConfigQueueSize == 0)
+            {
+                std::cerr << "The sub-configuration queue size must be at least 1!\n";
+                exit(-1);
+            }
         }
 
         if (vm.count("speed-limit"))
@@ -258,6 +430,186 @@ void sdddstCore::ProjectParser::processInput(boost::program_options::variables_m
             sD->remainingFinalSteps = vm["post-relax"].as<unsigned int>();
         }
 
+        if (vm.count("concurrent-stages"))
+        {
+            sD->concurrentStages = true;
+        }
+
+        if (vm.count("reuse-half-step"))
+        {
+            sD->reuseHalfStep = true;
+        }
+
+        if (vm.count("multirate-max-substeps"))
+        {
+            sD->multirateMaxSubsteps = vm["multirate-max-substeps"].as<unsigned int>();
+            sD->multirateMaxFastRatio = vm["multirate-max-fast-ratio"].as<double>();
+            if (sD->multirateMaxSubsteps < 2 || sD->multirateMaxFastRatio <= 0 || sD->multirateMaxFastRatio > 1)
+            {
+                std::cerr << "multirate-max-substeps should be at least 2 and multirate-max-fast-ratio should be in (0, 1]!\n";
+                exit(-1);
+            }
+        }
+
+        if (vm.count("dipole-distance"))
+        {
+            sD->isDipoleTreatment = true;
+            sD->dipoleDistance = vm["dipole-distance"].as<double>();
+            sD->multirateMaxFastRatio = vm["multirate-max-fast-ratio"].as<double>();
+            if (sD->dipoleDistance <= 0)
+            {
+                std::cerr << "dipole-distance should be positive!\n";
+                exit(-1);
+            }
+        }
+
+        if (vm.count("annihilation-distance"))
+        {
+            sD->isAnnihilation = true;
+            sD->annihilationDistance = vm["annihilation-distance"].as<double>();
+            if (sD->annihilationDistance <= 0)
+            {
+                std::cerr << "annihilation-distance should be positive!\n";
+                exit(-1);
+            }
+        }
+
+        if (vm.count("step-size-controller"))
+        {
+            std::string controller = vm["step-size-controller"].as<std::string>();
+            if (controller == "elementary")
+            {
+                sD->stepSizeController = std::unique_ptr<StepSizeController>(new StepSizeController());
+            }
+            else if (controller == "pi")
+            {
+                sD->stepSizeController = std::unique_ptr<StepSizeController>(new PIDController(CONTROLLER_INTEGRAL_GAIN, CONTROLLER_PROPORTIONAL_GAIN, 0));
+            }
+            else if (controller == "pid")
+            {
+                sD->stepSizeController = std::unique_ptr<StepSizeController>(new PIDController(CONTROLLER_INTEGRAL_GAIN, CONTROLLER_PROPORTIONAL_GAIN, CONTROLLER_DERIVATIVE_GAIN));
+            }
+            else
+            {
+                std::cerr << "Unknown step size controller: " << controller << "\n";
+                exit(-1);
+            }
+        }
+
+        if (vm.count("speculative-trials"))
+        {
+            sD->speculativeTrials = vm["speculative-trials"].as<unsigned int>();
+            if (sD->speculativeTrials < 2 || vm.count("reuse-half-step") || vm.count("dipole-distance"))
+            {
+                std::cerr << "speculative-trials should be at least 2 and it can not be used with reuse-half-step or dipole-distance!\n";
+                exit(-1);
+            }
+        }
+
+        if (vm.count("predictor-order"))
+        {
+            sD->predictorOrder = vm["predictor-order"].as<unsigned int>();
+            if (sD->predictorOrder > 2)
+            {
+                std::cerr << "predictor-order can be 0, 1 or 2!\n";
+                exit(-1);
+            }
+        }
+
+        if (vm.count("integrator"))
+        {
+            std::string integrator = vm["integrator"].as<std::string>();
+            if (integrator == "trapezoidal")
+            {
+                sD->integrator = TrapezoidalStepDoubling;
+            }
+            else if (integrator == "trapezoidal-embedded")
+            {
+                sD->integrator = TrapezoidalEmbedded;
+            }
+            else if (integrator == "ros34pw2")
+            {
+                sD->integrator = RosenbrockW;
+            }
+            else
+            {
+                std::cerr << "Unknown integrator: " << integrator << "\n";
+                exit(-1);
+            }
+        }
+
+        if (vm.count("richardson-extrapolation"))
+        {
+            if (sD->integrator != TrapezoidalStepDoubling)
+            {
+                std::cerr << "richardson-extrapolation can be used only with the trapezoidal integrator!\n";
+                exit(-1);
+            }
+            sD->richardsonExtrapolation = true;
+        }
+
+        if (vm.count("speculative-trials") && sD->integrator != TrapezoidalStepDoubling)
+        {
+            std::cerr << "speculative-trials can be used only with the trapezoidal integrator!\n";
+            exit(-1);
+        }
+
+        if (vm.count("concurrent-stages") && sD->integrator != TrapezoidalStepDoubling)
+        {
+            std::cerr << "concurrent-stages can be used only with the trapezoidal integrator!\n";
+            exit(-1);
+        }
+
+        if (vm.count("reuse-half-step") && sD->integrator != TrapezoidalStepDoubling)
+        {
+            std::cerr << "reuse-half-step can be used only with the trapezoidal integrator!\n";
+            exit(-1);
+        }
+
+        if (vm.count("multirate-max-substeps") && sD->integrator != TrapezoidalStepDoubling)
+        {
+            std::cerr << "multirate-max-substeps can be used only with the trapezoidal integrator!\n";
+            exit(-1);
+        }
+
+        if (vm.count("dipole-distance") && sD->integrator != TrapezoidalStepDoubling)
+        {
+            std::cerr << "dipole-distance can be used only with the trapezoidal integrator!\n";
+            exit(-1);
+        }
+
+        // ros34pw2 has no NR iteration and the embedded error estimate needs its own second order predictor
+        if (sD->predictorOrder > 0 && sD->integrator != TrapezoidalStepDoubling)
+        {
+            std::cerr << "predictor-order can be used only with the trapezoidal integrator!\n";
+            exit(-1);
+        }
+
+        if (vm.count("relaxation-force-tolerance"))
+        {
+            sD->relaxationForceTolerance = vm["relaxation-force-tolerance"].as<double>();
+            sD->relaxationMaxIterations = vm["relaxation-max-iterations"].as<unsigned int>();
+        }
+
+        if (vm.count("aqs-stress-step"))
+        {
+            sD->aqsStressStep = vm["aqs-stress-step"].as<double>();
+            sD->aqsAvalancheStrain = vm["aqs-avalanche-strain"].as<double>();
+        }
+
+        if (vm.count("newton-tolerance"))
+        {
+            sD->isNewtonConvergenceControlled = true;
+            sD->newtonTolerance = vm["newton-tolerance"].as<double>();
+            sD->minIterationCount = vm["min-iteration-count"].as<unsigned int>();
+            sD->maxIterationCount = vm["max-iteration-count"].as<unsigned int>();
+            if (sD->minIterationCount < 1 || sD->maxIterationCount < sD->minIterationCount)
+            {
+                std::cerr << "Invalid NR iteration count limits!\n";
+                exit(-1);
+            }
+        }
+
         sD->endDislocationConfigurationPath = vm["result-dislocation-configuration"].as<std::string>();
 
         sD->tau = std::unique_ptr<Field>(new AnalyticField());
@@ -316,6 +668,16 @@ void sdddstCore::ProjectParser::processInput(boost::program_options::variables_m
         if (vm.count("write-correlation-matrices") > 0) {
             sD->writeCorrelMatrices = vm["write-correlation-matrices"].as<int>();
         }
+
+        if (vm["ev-frame-stride"].as<unsigned int>() == 0) {
+            std::cerr << "ev-frame-stride must be at least 1!" << std::endl;
+            exit(-1);
+        }
+
+        if (vm.count("ev-start-time") && vm.count("ev-end-time") && vm["ev-start-time"].as<double>() > vm["ev-end-time"].as<double>()) {
+            std::cerr << "ev-start-time can not be later than ev-end-time!" << std::endl;
+            exit(-1);
+        }
     }
 }
 
@@ -331,7 +693,13 @@ std::shared_ptr<DataTimeSeries> ProjectParser::getDataTimeSeries()
 {
     if (getPType() == EV_ANALYZATION) {
         if (vm.count("pd-configuration") == 1 && vm.count("file-list") == 1) {
-            return std::shared_ptr<DataTimeSeries>(new DataTimeSeries(vm["file-list"].as<std::string>(), vm["pd-configuration"].as<std::string>()));
+            std::shared_ptr<DataTimeSeries> series(new DataTimeSeries(vm["file-list"].as<std::string>(), vm["pd-configuration"].as<std::string>()));
+            if (vm.count("ev-start-time") || vm.count("ev-end-time")) {
+                series->setTimeRange(vm.count("ev-start-time") ? vm["ev-start-time"].as<double>() : -std::numeric_limits<double>::infinity(),
+                                     vm.count("ev-end-time") ? vm["ev-end-time"].as<double>() : std::numeric_limits<double>::infinity());
+            }
+            series->setStride(vm["ev-frame-stride"].as<unsigned int>());
+            return series;
         }
     }
     return nullptr;
@@ -0,0 +1,297 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "constants.h"
+#include "quasistatic_loading.h"
+#include "utility.h"
+
+#ifdef BUILD_PYTHON_BINDINGS
+#include "simulation_data_wrapper.h"
+#endif
+
+#include <umfpack.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <iostream>
+
+using namespace sdddstCore;
+
+QuasistaticLoading::QuasistaticLoading(std::shared_ptr<SimulationData> _sD):
+    sD(_sD),
+    protocol(dynamic_cast<FixedRateProtocol*>(_sD->externalStressProtocol.get())),
+    simulation(_sD),
+    relaxation(_sD),
+    equilibrium(_sD->dislocations),
+    response(_sD->dc, 0),
+    softMode(_sD->dc, 0),
+    hasSoftMode(false),
+    force(_sD->dc, 0),
+    rhs(_sD->dc, 0),
+    stiffness(0),
+    lastStiffness(0),
+    lastTime(0),
+    hasLastStiffness(false),
+    predictedCriticalStress(0)
+{
+    if (protocol == nullptr || dynamic_cast<SpringProtocol*>(protocol) != nullptr || protocol->getRate() == 0)
+    {
+        std::cerr << "Quasistatic loading needs a fixed rate external stress protocol with nonzero rate and without spring!\n";
+        exit(-1);
+    }
+
+    // The loading starts from the equilibrium at the initial stress
+    relaxation.relax(false);
+    calculateResponse();
+}
+
+QuasistaticLoading::~QuasistaticLoading()
+{
+}
+
+void QuasistaticLoading::run()
+{
+    while( ((sD->isTimeLimit && sD->simTime < sD->timeLimit) || !sD->isTimeLimit) &&
+           ((sD->isStressLimit && getStress() < sD->stressLimit) || !sD->isStressLimit) &&
+           ((sD->isStrainIncreaseLimit && sD->totalAccumulatedStrainIncrease < sD->totalAccumulatedStrainIncreaseLimit) || !sD->isStrainIncreaseLimit) &&
+           ((sD->isStepCountLimit && sD->succesfulSteps < sD->stepCountLimit) || !sD->isStepCountLimit) &&
+           ((sD->countAvalanches && sD->avalancheCount < sD->avalancheTriggerLimit) || !sD->countAvalanches)
+           )
+    {
+        step();
+    }
+    simulation.getSubConfigurationWriter().flush();
+    sD->writeDislocationDataToFile(sD->endDislocationConfigurationPath);
+}
+
+bool QuasistaticLoading::step()
+{
+    // The critical time is extrapolated linearly from the stiffness of the last two equilibria on the same branch,
+    // half of the remaining distance is taken, but at least the resolution and at most the given increment
+    double maxIncrement = sD->aqsStressStep / fabs(protocol->getRate());
+    double increment = maxIncrement;
+    bool hasPrediction = hasLastStiffness && stiffness < lastStiffness;
+    if (hasPrediction)
+    {
+        double remaining = stiffness * (sD->simTime - lastTime) / (lastStiffness - stiffness);
+        predictedCriticalStress = protocol->getRate() * (sD->simTime + remaining);
+        increment = std::min(std::max(AQS_APPROACH_FRACTION * remaining, AQS_MIN_STRESS_STEP_RATIO * maxIncrement), maxIncrement);
+    }
+
+    // The relaxation starts from the linear response to the increment
+    lastStiffness = stiffness;
+    lastTime = sD->simTime;
+    hasLastStiffness = true;
+    double elasticStrain = 0;
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        equilibrium[i] = sD->dislocations[i];
+        sD->dislocations[i].x += increment * response[i];
+        elasticStrain += sD->dislocations[i].b * increment * response[i];
+    }
+    sD->simTime += increment;
+
+    // If the Newton iteration does not find the equilibrium on the same branch, an instability was crossed
+    size_t iterations = newtonRelax();
+    bool crossedInstability = iterations == 0;
+    if (crossedInstability)
+    {
+        for (size_t i = 0; i < sD->dc; i++)
+        {
+            sD->dislocations[i].x = equilibrium[i].x + increment * response[i];
+        }
+        size_t start = relaxation.getIterationCount();
+        relaxation.reset();
+        relaxation.relax(false);
+        iterations = AQS_MAX_NEWTON_ITERATIONS + relaxation.getIterationCount() - start;
+    }
+
+    // The strain beyond the linear response is the plastic strain of the avalanche,
+    // after an avalanche the system is on a new branch, so the stiffness history is dropped
+    double strain = calculateStrainIncrement(equilibrium, sD->dislocations);
+    double plasticStrain = strain - elasticStrain;
+    bool avalanche = crossedInstability && (protocol->getRate() > 0 ? plasticStrain : -plasticStrain) > sD->aqsAvalancheStrain;
+    sD->totalAccumulatedStrainIncrease += strain;
+    sD->succesfulSteps++;
+    if (avalanche)
+    {
+        sD->avalancheCount++;
+        hasLastStiffness = false;
+    }
+    calculateResponse();
+
+    sD->standardOutputLog << getStress() << " " <<
+                             sD->totalAccumulatedStrainIncrease << " " <<
+                             plasticStrain << " " <<
+                             iterations << " ";
+    if (hasPrediction)
+    {
+        sD->standardOutputLog << predictedCriticalStress;
+    }
+    else
+    {
+        sD->standardOutputLog << "-";
+    }
+    sD->standardOutputLog << " " << sD->avalancheCount << "\n";
+
+    if (avalanche && sD->isSaveSubConfigs)
+    {
+        // Same format as a stream with 16 digit precision
+        char name[32];
+        snprintf(name, sizeof(name), "/%.16g.dconf", sD->simTime);
+        subConfigFileName.assign(sD->subConfigPath).append(name);
+        simulation.getSubConfigurationWriter().push(subConfigFileName, sD->simTime, sD->dislocations);
+    }
+
+    return avalanche;
+}
+
+double QuasistaticLoading::getStress() const
+{
+    return sD->externalStressProtocol->getStress(Original);
+}
+
+void QuasistaticLoading::factorizeJacobian()
+{
+    // The Rosenbrock form of the Jacobian is used, the large H only regularizes the uniform translation of the system
+    simulation.calculateJacobian(sD->bigStepWorkspace, AQS_JACOBIAN_STEP_SIZE, sD->dislocations, 1.0);
+    simulation.calculateSparseFormForJacobian(sD->bigStepWorkspace);
+}
+
+void QuasistaticLoading::solve(const std::vector<double> & rhs)
+{
+    IntegratorWorkspace & ws = sD->bigStepWorkspace;
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        ws.g[i] = AQS_JACOBIAN_STEP_SIZE * rhs[i];
+    }
+    simulation.solveEQSys(ws);
+}
+
+void QuasistaticLoading::calculateResponse()
+{
+    // The force changes by b * rate in unit time, so the response is -J^-1 b * rate
+    IntegratorWorkspace & ws = sD->bigStepWorkspace;
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        rhs[i] = sD->dislocations[i].b * protocol->getRate();
+    }
+    factorizeJacobian();
+    solve(rhs);
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        response[i] = ws.x[i];
+    }
+
+    // Inverse iteration started from the previous soft mode (from the response for the first time), without point defects
+    // the uniform translation is a zero mode which is projected out, so the smallest nonzero eigenvalue is found
+    if (!hasSoftMode)
+    {
+        softMode = response;
+        hasSoftMode = true;
+    }
+    double eigenValue = 0;
+    for (size_t k = 0; k < AQS_INVERSE_ITERATIONS; k++)
+    {
+        double mean = 0;
+        if (sD->pc == 0)
+        {
+            mean = std::accumulate(softMode.begin(), softMode.end(), 0.0) / double(sD->dc);
+        }
+        double norm = 0;
+        for (auto & v: softMode)
+        {
+            v -= mean;
+            norm += v * v;
+        }
+        norm = sqrt(norm);
+        if (norm == 0)
+        {
+            break;
+        }
+        for (auto & v: softMode)
+        {
+            v /= norm;
+        }
+        solve(softMode);
+        norm = 0;
+        for (size_t i = 0; i < sD->dc; i++)
+        {
+            softMode[i] = ws.x[i];
+            norm += ws.x[i] * ws.x[i];
+        }
+        eigenValue = 1.0 / sqrt(norm);
+    }
+    umfpack_di_free_numeric (&ws.Numeric);
+    stiffness = eigenValue * eigenValue;
+}
+
+size_t QuasistaticLoading::newtonRelax()
+{
+    IntegratorWorkspace & ws = sD->bigStepWorkspace;
+    sD->externalStressProtocol->calculateStress(sD->simTime, sD->dislocations, Original);
+    double initialMaxForce = 0;
+    for (size_t i = 0; i < AQS_MAX_NEWTON_ITERATIONS; i++)
+    {
+        simulation.calculateSpeeds(sD->dislocations, force, Original, nullptr);
+        double maxForce = 0;
+        for (auto f: force)
+        {
+            maxForce = std::max(maxForce, fabs(f));
+        }
+        if (maxForce < sD->relaxationForceTolerance)
+        {
+            return i + 1;
+        }
+        // Without a stable equilibrium nearby the iteration does not converge, the close pairs can make the
+        // residual oscillate near the tolerance, so only leaving the neighbourhood of the start is treated as divergence
+        if (i == 0)
+        {
+            initialMaxForce = maxForce;
+        }
+        else if (!(maxForce == maxForce) || maxForce > initialMaxForce)
+        {
+            return 0;
+        }
+
+        factorizeJacobian();
+        solve(force);
+        umfpack_di_free_numeric (&ws.Numeric);
+        for (size_t j = 0; j < sD->dc; j++)
+        {
+            sD->dislocations[j].x += ws.x[j];
+        }
+    }
+    return 0;
+}
+
+#ifdef BUILD_PYTHON_BINDINGS
+QuasistaticLoading *QuasistaticLoading::create(boost::python::object simulationData)
+{
+    boost::python::extract<PySdddstCore::PySimulationData&> x(simulationData);
+    if (x.check())
+    {
+        PySdddstCore::PySimulationData& tmp = x();
+        return new QuasistaticLoading{tmp.get()};
+    }
+    return nullptr;
+}
+#endif
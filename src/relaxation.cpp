@@ -0,0 +1,233 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "constants.h"
+#include "relaxation.h"
+#include "utility.h"
+
+#ifdef BUILD_PYTHON_BINDINGS
+#include "simulation_data_wrapper.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+using namespace sdddstCore;
+
+Relaxation::Relaxation(std::shared_ptr<SimulationData> _sD):
+    sD(_sD),
+    simulation(_sD),
+    force(_sD->dc, 0),
+    direction(_sD->dc, 0),
+    velocity(_sD->dc, 0),
+    stiffness(_sD->dc, 0),
+    partner(_sD->dc, 0),
+    coupling(_sD->dc, 0),
+    timeStep(FIRE_INITIAL_TIME_STEP),
+    alpha(FIRE_ALPHA_START),
+    stepsSinceUphill(0),
+    iterations(0),
+    maxForce(0),
+    rmsForce(0)
+{
+    reset();
+}
+
+Relaxation::~Relaxation()
+{
+}
+
+void Relaxation::run()
+{
+    relax();
+    sD->writeDislocationDataToFile(sD->endDislocationConfigurationPath);
+}
+
+void Relaxation::relax(bool logIterations)
+{
+    size_t limit = iterations + sD->relaxationMaxIterations;
+    while (maxForce >= sD->relaxationForceTolerance && iterations < limit)
+    {
+        step();
+        if (logIterations)
+        {
+            sD->standardOutputLog << iterations << " " << maxForce << " " << rmsForce << " " << timeStep << "\n";
+        }
+    }
+}
+
+void Relaxation::reset()
+{
+    std::fill(velocity.begin(), velocity.end(), 0);
+    timeStep = FIRE_INITIAL_TIME_STEP;
+    alpha = FIRE_ALPHA_START;
+    stepsSinceUphill = 0;
+
+    // The relaxation is done at the current external stress
+    sD->externalStressProtocol->calculateStress(sD->simTime, sD->dislocations, Original);
+    calculateForces();
+}
+
+bool Relaxation::step()
+{
+    double power = 0;
+    double directionNorm = 0;
+    double velocityNorm = 0;
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        power += force[i] * velocity[i];
+        directionNorm += direction[i] * direction[i];
+        velocityNorm += velocity[i] * velocity[i];
+    }
+    directionNorm = sqrt(directionNorm);
+    velocityNorm = sqrt(velocityNorm);
+
+    // Going downhill the velocity is turned towards the acceleration and the time step is increased,
+    // uphill the system is stopped and restarted more carefully
+    if (power > 0)
+    {
+        double mix = directionNorm > 0 ? alpha * velocityNorm / directionNorm : 0;
+        for (size_t i = 0; i < sD->dc; i++)
+        {
+            velocity[i] = (1.0 - alpha) * velocity[i] + mix * direction[i];
+        }
+        if (++stepsSinceUphill > FIRE_N_MIN)
+        {
+            timeStep = std::min(timeStep * FIRE_TIME_STEP_INCREASE, FIRE_MAX_TIME_STEP);
+            alpha *= FIRE_ALPHA_DECREASE;
+        }
+    }
+    else
+    {
+        std::fill(velocity.begin(), velocity.end(), 0);
+        timeStep *= FIRE_TIME_STEP_DECREASE;
+        alpha = FIRE_ALPHA_START;
+        stepsSinceUphill = 0;
+    }
+
+    // Semi-implicit Euler step, no dislocation can jump further than the limit
+    double maxDisplacement = 0;
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        velocity[i] += timeStep * direction[i];
+        maxDisplacement = std::max(maxDisplacement, fabs(timeStep * velocity[i]));
+    }
+    double scale = maxDisplacement > FIRE_MAX_DISPLACEMENT ? FIRE_MAX_DISPLACEMENT / maxDisplacement : 1.0;
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        velocity[i] *= scale;
+        sD->dislocations[i].x += timeStep * velocity[i];
+    }
+
+    calculateForces();
+    iterations++;
+
+    return maxForce < sD->relaxationForceTolerance;
+}
+
+double Relaxation::getMaxForce() const
+{
+    return maxForce;
+}
+
+size_t Relaxation::getIterationCount() const
+{
+    return iterations;
+}
+
+void Relaxation::calculateForces()
+{
+    simulation.calculateSpeeds(sD->dislocations, force, Original, nullptr);
+    maxForce = 0;
+    rmsForce = 0;
+    for (auto f: force)
+    {
+        maxForce = std::max(maxForce, fabs(f));
+        rmsForce += f * f;
+    }
+    rmsForce = sqrt(rmsForce / double(sD->dc));
+
+    // Sum of the absolute values in every row of the force Jacobian and the strongest coupling
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        stiffness[i] = fabs(simulation.calculatePointDefectJacobianDiagonal(sD->dislocations[i])) + EPS;
+        coupling[i] = 0;
+        partner[i] = i;
+    }
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        for (size_t j = i + 1; j < sD->dc; j++)
+        {
+            double dx = sD->dislocations[i].x - sD->dislocations[j].x;
+            normalize(dx);
+
+            double dy = sD->dislocations[i].y - sD->dislocations[j].y;
+            normalize(dy);
+
+            double k = sD->dislocations[i].b * sD->dislocations[j].b * sD->tau->xy_diff_x(dx, dy);
+            stiffness[i] += fabs(k);
+            stiffness[j] += fabs(k);
+            if (fabs(k) > fabs(coupling[i]))
+            {
+                coupling[i] = k;
+                partner[i] = j;
+            }
+            if (fabs(k) > fabs(coupling[j]))
+            {
+                coupling[j] = k;
+                partner[j] = i;
+            }
+        }
+    }
+
+    // The direction is the force preconditioned with a diagonally dominant approximation of the Hessian.
+    // Close pairs are handled together, so their common motion is not slowed down by their strong coupling.
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        size_t j = partner[i];
+        bool isPair = j != i && partner[j] == i &&
+                fabs(coupling[i]) > FIRE_PAIR_COUPLING_RATIO * stiffness[i] && fabs(coupling[i]) > FIRE_PAIR_COUPLING_RATIO * stiffness[j];
+        if (!isPair)
+        {
+            direction[i] = force[i] / (2.0 * stiffness[i]);
+        }
+        else if (i < j)
+        {
+            double k = fabs(coupling[i]);
+            double mi = 2.0 * stiffness[i] - k;
+            double mj = 2.0 * stiffness[j] - k;
+            double det = mi * mj - coupling[i] * coupling[i];
+            direction[i] = (mj * force[i] - coupling[i] * force[j]) / det;
+            direction[j] = (mi * force[j] - coupling[i] * force[i]) / det;
+        }
+    }
+}
+
+#ifdef BUILD_PYTHON_BINDINGS
+Relaxation *Relaxation::create(boost::python::object simulationData)
+{
+    boost::python::extract<PySdddstCore::PySimulationData&> x(simulationData);
+    if (x.check())
+    {
+        PySdddstCore::PySimulationData& tmp = x();
+        return new Relaxation{tmp.get()};
+    }
+    return nullptr;
+}
+#endif
@@ -17,9 +17,11 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
  */
 
+#include "allocation_counter.h"
+#include "checkpoint.h"
+#include "constants.h"
 #include "simulation.h"
 #include "utility.h"
-#include "StressProtocols/spring_protocol.h"
 
 #ifdef BUILD_PYTHON_BINDINGS
 #include "simulation_data_wrapper.h"
@@ -27,24 +29,138 @@
 
 #include <umfpack.h>
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <numeric>
+#include <cstdio>
 #include <cstdlib>
-#include <sstream>
+#include <thread>
+#include <typeinfo>
+#include <utility>
 
 using namespace sdddstCore;
 
+namespace
+{
+
+/**
+ * @brief The RosenbrockTableau struct stores the coefficients of the ROS34PW2 method (Rang, Angermann)
+ * in the transformed form where the stages are u_i = sum_j gamma_ij k_j, see Hairer, Wanner IV.7
+ */
+struct RosenbrockTableau
+{
+    static const int stageCount = 4;
+
+    double gamma;
+    // Relative time of the stages
+    double alpha[stageCount];
+    // Coefficients of the time derivative of the right hand side (row sums of the gamma matrix)
+    double gammaSum[stageCount];
+    // Coefficients of the stage positions
+    double a[stageCount][stageCount];
+    // Coefficients of the previous stages on the right hand side
+    double c[stageCount][stageCount];
+    // Coefficients of the third order solution
+    double m[stageCount];
+    // Coefficients of the error estimate (difference of the third and second order solutions)
+    double e[stageCount];
+
+    RosenbrockTableau() : gamma(4.3586652150845900e-01)
+    {
+        const double A[stageCount][stageCount] = {
+            {0, 0, 0, 0},
+            {8.7173304301691801e-01, 0, 0, 0},
+            {8.4457060015369423e-01, -1.1299064236484185e-01, 0, 0},
+            {0, 0, 1, 0}
+        };
+        const double G[stageCount][stageCount] = {
+            {gamma, 0, 0, 0},
+            {-8.7173304301691801e-01, gamma, 0, 0},
+            {-9.0338057013044082e-01, 5.4180672388095326e-02, gamma, 0},
+            {2.4212380706095346e-01, -1.2232505839045147e+00, 5.4526025533510214e-01, gamma}
+        };
+        const double b[stageCount] = {2.4212380706095346e-01, -1.2232505839045147e+00, 1.5452602553351020e+00, 4.3586652150845900e-01};
+        const double bHat[stageCount] = {3.7810903145819369e-01, -9.6042292212423178e-02, 0.5, 2.1793326075422950e-01};
+
+        // Inverse of the lower triangular gamma matrix by forward substitution
+        double GInv[stageCount][stageCount] = {};
+        for (int j = 0; j < stageCount; j++)
+        {
+            GInv[j][j] = 1.0 / gamma;
+            for (int i = j + 1; i < stageCount; i++)
+            {
+                double sum = 0;
+                for (int k = j; k < i; k++)
+                {
+                    sum += G[i][k] * GInv[k][j];
+                }
+                GInv[i][j] = -sum / gamma;
+            }
+        }
+
+        for (int i = 0; i < stageCount; i++)
+        {
+            alpha[i] = 0;
+            gammaSum[i] = 0;
+            m[i] = 0;
+            e[i] = 0;
+            for (int j = 0; j < stageCount; j++)
+            {
+                alpha[i] += A[i][j];
+                gammaSum[i] += G[i][j];
+                a[i][j] = 0;
+                for (int k = 0; k < stageCount; k++)
+                {
+                    a[i][j] += A[i][k] * GInv[k][j];
+                }
+                c[i][j] = (i == j ? 1.0 / gamma : 0.0) - GInv[i][j];
+                m[i] += b[j] * GInv[j][i];
+                e[i] += (b[j] - bHat[j]) * GInv[j][i];
+            }
+        }
+    }
+};
+
+const RosenbrockTableau ros34pw2;
+
+/**
+ * @brief getErrorEstimateOrder returns the power of the step size in the local error estimate of the integrator
+ */
+double getErrorEstimateOrder(IntegratorType integrator)
+{
+    switch (integrator)
+    {
+    case TrapezoidalStepDoubling:
+        // Difference of the big step and the two half steps of the second order rule
+        return DEFAULT_ERROR_ESTIMATE_ORDER;
+    case TrapezoidalEmbedded:
+        // Milne's device: difference of the second order predictor and the corrector
+        return DEFAULT_ERROR_ESTIMATE_ORDER;
+    case RosenbrockW:
+        // Difference of the third order solution and the embedded second order one
+        return DEFAULT_ERROR_ESTIMATE_ORDER;
+    }
+    return DEFAULT_ERROR_ESTIMATE_ORDER;
+}
+
+}
+
 Simulation::Simulation(std::shared_ptr<SimulationData> _sD) :
     succesfulStep(true),
     lastWriteTimeFinished(0),
     initSpeedCalculationIsNeeded(true),
     firstStepRequest(true),
+    bigStepIsReady(false),
     energy(0),
     energyAccum(0),
     vsquare(0),
+    newtonIterations(0),
+    lastStepSize(0),
     sD(_sD),
-    pH(new PrecisionHandler)
+    pH(new PrecisionHandler),
+    subConfigWriter(_sD->subConfigQueueSize),
+    logAggregator()
 {
 
     // Format setting
@@ -52,6 +168,55 @@ Simulation::Simulation(std::shared_ptr<SimulationData> _sD) :
 
     pH->setMinPrecisity(sD->prec);
     pH->setSize(sD->dc);
+
+    sD->stepSizeController->setErrorOrder(getErrorEstimateOrder(sD->integrator));
+
+    sD->bigStepWorkspace.tolerance.setMinPrecisity(sD->prec);
+    sD->bigStepWorkspace.tolerance.setSize(sD->dc);
+    sD->bigStepWorkspace.tolerance.reset();
+    sD->smallStepWorkspace.tolerance.setMinPrecisity(sD->prec);
+    sD->smallStepWorkspace.tolerance.setSize(sD->dc);
+    sD->smallStepWorkspace.tolerance.reset();
+
+    std::vector<std::string> columns = {"time", "successful_steps", "failed_steps", "max_error_ratio_sqr", "average_speed", "cutoff",
+                                        "order_parameter", "external_stress", "wall_time", "strain", "v_square", "energy"};
+    if (sD->isNewtonConvergenceControlled)
+    {
+        columns.push_back("newton_iterations");
+    }
+
+    if (sD->logStepInterval > 0 || sD->logTimeWindow > 0 || sD->logFullDuringAvalanche)
+    {
+        logAggregator.reset(new LogAggregator(sD->logStepInterval, sD->logTimeWindow, sD->logFullDuringAvalanche, sD->avalancheSpeedThreshold));
+        logAggregator->setColumnCount(columns.size());
+        columns = logAggregator->getColumnNames(columns);
+    }
+
+    if (sD->binaryLog)
+    {
+        if (sD->binaryLog->getColumnCount() == 0)
+        {
+            sD->binaryLog->setColumns(columns);
+        }
+        else if (sD->binaryLog->getColumnCount() != columns.size())
+        {
+            std::cerr << "The columns of the continued binary log do not match!\n";
+            exit(-1);
+        }
+    }
+
+    if (!sD->trajectoryPath.empty())
+    {
+        // The delta encoding keeps the positions within the half of the required precision
+        TrajectoryEncoding encoding = sD->deltaEncodeTrajectory ? TrajectoryDelta : (sD->compressTrajectory ? TrajectoryZlib : TrajectoryRaw);
+        // A restarted run continues the trajectory truncated by the parser, a new run overwrites it
+        subConfigWriter.setTrajectory(sD->trajectoryPath, sD->trajectoryChunkSize, encoding, sD->prec, !sD->restartPath.empty());
+    }
+
+    if (!sD->restartPath.empty())
+    {
+        readCheckpoint(sD->restartPath);
+    }
 }
 
 Simulation::~Simulation()
@@ -59,31 +224,87 @@ Simulation::~Simulation()
 }
 
 
-void Simulation::integrate(const double &stepsize, std::vector<Dislocation> &newDislocation, const std::vector<Dislocation> & old,
-                           bool useSpeed2, bool calculateInitSpeed, StressProtocolStepType origin, StressProtocolStepType end)
+void Simulation::integrate(IntegratorWorkspace &ws, const double &stepsize, std::vector<Dislocation> &newDislocation, const std::vector<Dislocation> & old,
+                           bool useSpeed2, bool calculateInitSpeed, StressProtocolStepType origin, StressProtocolStepType end, bool startFromOld)
 {
-    calculateJacobian(stepsize, newDislocation);
-    calculateSparseFormForJacobian();
-    for (size_t i = 0; i < sD->ic; i++)
+    // Without a predictor the initial guess is the old configuration, so newDislocation is only written by the first iteration
+    calculateJacobian(ws, stepsize, startFromOld ? old : newDislocation);
+    calculateSparseFormForJacobian(ws);
+
+    // The strain increment of the integrated buffer follows the corrections
+    double & strainIncrement = end == EndOfBigStep ? sD->bigStepStrainIncrement : (end == EndOfFirstSmallStep ? sD->firstSmallStrainIncrement : sD->secondSmallStrainIncrement);
+    strainIncrement = startFromOld ? 0 : calculateStrainIncrement(old, newDislocation);
+    ws.stressIsValid = false;
+
+    size_t iterationLimit = sD->ic;
+    bool converged = true;
+    double lastCorrection = 0;
+    if (sD->isNewtonConvergenceControlled)
+    {
+        iterationLimit = sD->maxIterationCount;
+        converged = false;
+    }
+
+    for (size_t i = 0; i < iterationLimit; i++)
     {
         if (i > 0)
         {
-            calculateG(stepsize, newDislocation, old, useSpeed2, false, false, origin, end);
+            calculateG(ws, stepsize, newDislocation, old, useSpeed2, false, false, origin, end);
         }
         else
         {
-            calculateG(stepsize, newDislocation, old, useSpeed2, calculateInitSpeed, sD->externalStressProtocol->getType() == "zero-stress" ? true : false, origin, end);
+            // Without external stress the speeds at the start are the same as the initial speeds unless a predictor moved the dislocations
+            bool zeroStress = typeid(*sD->externalStressProtocol) == typeid(StressProtocol);
+            calculateG(ws, stepsize, startFromOld ? old : newDislocation, old, useSpeed2, calculateInitSpeed, zeroStress && startFromOld, origin, end);
+        }
+        solveEQSys(ws);
+        double correction = 0;
+        double strainChange = 0;
+        if (i == 0 && startFromOld)
+        {
+            for (size_t j = 0; j < sD->dc; j++)
+            {
+                newDislocation[j] = old[j];
+            }
         }
-        solveEQSys();
         for (size_t j = 0; j < sD->dc; j++)
         {
-            newDislocation[j].x -= sD->x[j];
+            newDislocation[j].x -= ws.x[j];
+            strainChange += newDislocation[j].b * ws.x[j];
+            correction = std::max(correction, fabs(ws.x[j]));
+        }
+        strainIncrement -= strainChange;
+        ws.iterationCount++;
+
+        if (sD->isNewtonConvergenceControlled)
+        {
+            // A growing (or NaN) correction means the iteration is diverging
+            if (!(correction == correction) || (i > 0 && correction > lastCorrection))
+            {
+                break;
+            }
+            if (i + 1 >= sD->minIterationCount && correction < sD->newtonTolerance * sD->prec)
+            {
+                converged = true;
+                break;
+            }
+            lastCorrection = correction;
         }
     }
-    umfpack_di_free_numeric (&sD->Numeric) ;
+
+    if (!converged)
+    {
+        ws.newtonFailed = true;
+    }
+    umfpack_di_free_numeric (&ws.Numeric) ;
 }
 
 void Simulation::calculateSpeeds(const std::vector<Dislocation> &dis, std::vector<double> &res, bool ignorePHUpdate)
+{
+    calculateSpeeds(dis, res, sD->currentStressStateType, ignorePHUpdate ? nullptr : pH.get());
+}
+
+void Simulation::calculateSpeeds(const std::vector<Dislocation> &dis, std::vector<double> &res, StressProtocolStepType type, PrecisionHandler *ph)
 {
     std::fill(res.begin(), res.end(), 0);
 
@@ -100,9 +321,9 @@ void Simulation::calculateSpeeds(const std::vector<Dislocation> &dis, std::vecto
             double tmp = dis[i].b * dis[j].b * sD->tau->xy(dx, dy);
 
             double r2 = dx*dx+dy*dy;
-            if (!ignorePHUpdate) {
-                pH->updateTolerance(r2, i);
-                pH->updateTolerance(r2, j);
+            if (ph) {
+                ph->updateTolerance(r2, i);
+                ph->updateTolerance(r2, j);
             }
             res[i] +=  tmp;
             res[j] -=  tmp;
@@ -122,42 +343,27 @@ void Simulation::calculateSpeeds(const std::vector<Dislocation> &dis, std::vecto
             double expXY = exp(-sD->KASQR * rSqr);
             res[i] -= 2.0 * sD->A * X(dx) * X(dy) * ((1.-expXY)/rSqr- sD->KASQR * expXY) / rSqr * dis[i].b;
 
-            if (!ignorePHUpdate) {
-                pH->updateTolerance(rSqr, i);
+            if (ph) {
+                ph->updateTolerance(rSqr, i);
             }
         }
-        res[i] += dis[i].b * sD->externalStressProtocol->getStress(sD->currentStressStateType);
+        res[i] += dis[i].b * sD->externalStressProtocol->getStress(type);
     }
 }
 
-void Simulation::calculateG(const double &stepsize, std::vector<Dislocation> &newDislocation, const std::vector<Dislocation> &old,
+void Simulation::calculateG(IntegratorWorkspace &ws, const double &stepsize, const std::vector<Dislocation> &newDislocation, const std::vector<Dislocation> &old,
                             bool useSpeed2, bool calculateInitSpeed, bool useInitSpeedForFirstStep, sdddstCore::StressProtocolStepType origin, sdddstCore::StressProtocolStepType end)
 {
     std::vector<double> * isp = &(sD->initSpeed);
-    std::vector<double> * csp = &(sD->speed);
+    std::vector<double> * csp = &(ws.speed);
     if (useSpeed2)
     {
         isp = &(sD->initSpeed2);
-        csp = &(sD->speed2);
     }
 
     if (calculateInitSpeed)
     {
-        double t = sD->simTime;
-        double tasi = sD->totalAccumulatedStrainIncrease;
-        if (origin == sdddstCore::StressProtocolStepType::EndOfFirstSmallStep)
-        {
-            t += sD->stepSize * 0.5;
-            tasi += calculateStrainIncrement(sD->dislocations, sD->firstSmall);
-        }
-
-        if (sD->externalStressProtocol->getType() == "spring-stress") {
-            static_cast<sdddstCore::SpringProtocol*>(sD->externalStressProtocol.get())->calculateStress(t, old, origin, tasi);
-        } else {
-            sD->externalStressProtocol->calculateStress(t, old, origin);
-        }
-        sD->currentStressStateType = origin;
-        calculateSpeeds(old, *isp);
+        this->calculateInitSpeed(ws, old, *isp, origin);
     }
 
     if (useInitSpeedForFirstStep)
@@ -167,32 +373,87 @@ void Simulation::calculateG(const double &stepsize, std::vector<Dislocation> &ne
     else
     {
         double t = sD->simTime + sD->stepSize;
-        double tasi = sD->totalAccumulatedStrainIncrease;
         if (end == EndOfFirstSmallStep)
         {
             t -= sD->stepSize * 0.5;
-            tasi += calculateStrainIncrement(sD->dislocations, sD->firstSmall);
-        } else if (end == EndOfSecondSmallStep) {
-            tasi += calculateStrainIncrement(sD->dislocations, sD->firstSmall) + calculateStrainIncrement(sD->firstSmall, sD->secondSmall);
-        } else if (end == EndOfBigStep) {
-            tasi += calculateStrainIncrement(sD->dislocations, sD->bigStep);
-        }
-        if (sD->externalStressProtocol->getType() == "spring-stress") {
-            static_cast<sdddstCore::SpringProtocol*>(sD->externalStressProtocol.get())->calculateStress(t, newDislocation, end, tasi);
-        } else {
-            sD->externalStressProtocol->calculateStress(t, newDislocation, end);
         }
-        sD->currentStressStateType = end;
-        calculateSpeeds(newDislocation, *csp);
+
+        // Only the spring protocol depends on the strain, the stress is recalculated only if its inputs changed
+        SpringProtocol * spring = getSpringProtocol();
+        double tasi = 0;
+        if (spring)
+        {
+            tasi = sD->totalAccumulatedStrainIncrease;
+            if (end == EndOfFirstSmallStep) {
+                tasi += sD->firstSmallStrainIncrement;
+            } else if (end == EndOfSecondSmallStep) {
+                tasi += sD->firstSmallStrainIncrement + sD->secondSmallStrainIncrement;
+            } else if (end == EndOfBigStep) {
+                tasi += sD->bigStepStrainIncrement;
+            }
+        }
+        if (!ws.stressIsValid || ws.stressTime != t || ws.stressStrain != tasi)
+        {
+            if (spring) {
+                spring->calculateStress(t, newDislocation, end, tasi);
+            } else {
+                sD->externalStressProtocol->calculateStress(t, newDislocation, end);
+            }
+            ws.stressIsValid = true;
+            ws.stressTime = t;
+            ws.stressStrain = tasi;
+        }
+        calculateSpeeds(newDislocation, *csp, end, &ws.tolerance);
+    }
+
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        ws.g[i] = newDislocation[i].x - (1.0+ws.dVec[i]) * 0.5 * stepsize * (*csp)[i] - old[i].x - (1.0 - ws.dVec[i]) * 0.5 * stepsize * (*isp)[i];
+    }
+}
+
+void Simulation::calculateInitSpeed(IntegratorWorkspace &ws, const std::vector<Dislocation> &old, std::vector<double> &isp, StressProtocolStepType origin)
+{
+    double t = sD->simTime;
+    double tasi = sD->totalAccumulatedStrainIncrease;
+    if (origin == sdddstCore::StressProtocolStepType::EndOfFirstSmallStep)
+    {
+        t += sD->stepSize * 0.5;
+        tasi += sD->firstSmallStrainIncrement;
+    }
+
+    if (SpringProtocol * spring = getSpringProtocol()) {
+        spring->calculateStress(t, old, origin, tasi);
+    } else {
+        sD->externalStressProtocol->calculateStress(t, old, origin);
+    }
+    calculateSpeeds(old, isp, origin, &ws.tolerance);
+}
+
+void Simulation::predict(std::vector<Dislocation> &newDislocation, const std::vector<Dislocation> &old, const std::vector<double> &speed,
+                         const std::vector<double> &previousSpeed, double previousStepSize, const double &stepsize, unsigned int order)
+{
+    // First order: explicit Euler step with the initial speeds
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        newDislocation[i] = old[i];
+        newDislocation[i].x += stepsize * speed[i];
     }
 
+    // Second order: the acceleration is estimated from the speeds previousStepSize earlier
+    if (order < 2 || previousStepSize <= 0 || previousSpeed.size() != sD->dc)
+    {
+        return;
+    }
+
+    double multiplier = 0.5 * stepsize * stepsize / previousStepSize;
     for (size_t i = 0; i < sD->dc; i++)
     {
-        sD->g[i] = newDislocation[i].x - (1.0+sD->dVec[i]) * 0.5 * stepsize * (*csp)[i] - old[i].x - (1.0 - sD->dVec[i]) * 0.5 * stepsize * (*isp)[i];
+        newDislocation[i].x += multiplier * (speed[i] - previousSpeed[i]);
     }
 }
 
-double Simulation::getElement(int j, int si, int ei)
+double Simulation::getElement(const IntegratorWorkspace &ws, int j, int si, int ei)
 {
     int len = ei - si;
     if (len > 1)
@@ -200,9 +461,9 @@ double Simulation::getElement(int j, int si, int ei)
         int tmp = len /2;
         double a;
 
-        if (sD->Ai[si+tmp] > j)
+        if (ws.Ai[si+tmp] > j)
         {
-            a = getElement(j, si, si + tmp);
+            a = getElement(ws, j, si, si + tmp);
             if (a != 0.0)
             {
                 return a;
@@ -210,7 +471,7 @@ double Simulation::getElement(int j, int si, int ei)
         }
         else
         {
-            a = getElement(j, si + tmp, ei);
+            a = getElement(ws, j, si + tmp, ei);
             if (a != 0.0)
             {
                 return a;
@@ -219,9 +480,9 @@ double Simulation::getElement(int j, int si, int ei)
     }
     else
     {
-        if (sD->Ai[si] == j)
+        if (ws.Ai[si] == j)
         {
-            return sD->Ax[si];
+            return ws.Ax[si];
         }
         return 0;
     }
@@ -233,96 +494,104 @@ double Simulation::getSimTime()
     return sD->simTime;
 }
 
-void Simulation::calculateJacobian(const double & stepsize, const std::vector<Dislocation> & data)
+double Simulation::calculatePointDefectJacobianDiagonal(const Dislocation &d)
+{
+    double tmp = 0;
+    double dx;
+    double dy;
+    for (size_t l = 0; l < sD->pc; l++)
+    {
+        dx = d.x - sD->points[l].x;
+        normalize(dx);
+        dy = d.y - sD->points[l].y;
+        normalize(dy);
+
+        if (pow(sqrt(dx * dx + dy * dy) - sD->cutOff, 2) < 36.8 * sD->cutOffSqr)
+        {
+            double multiplier = 1;
+            if (dx * dx + dy * dy > sD->cutOffSqr)
+            {
+                multiplier = exp(-pow(sqrt(dx*dx+dy*dy)-sD->cutOff, 2) * sD->onePerCutOffSqr);
+            }
+            tmp -= d.b * (- sD->A * cos(0.2e1 * M_PI * dx) / M_PI * sin(0.2e1 * M_PI * dy) * ((0.1e1 - pow(M_E, -sD->KASQR * ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 +
+                                                                                                                                    (0.1e1 - cos(0.2e1 * M_PI * dy)) * pow(M_PI, -0.2e1) / 0.2e1))) /
+                                                                                                    ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) *
+                                                                                                     pow(M_PI, -0.2e1) / 0.2e1) - sD->KASQR * pow(M_E, -sD->KASQR * ((0.1e1 - cos(0.2e1 * M_PI * dx)) *
+                                                                                                                                                                     pow(M_PI, -0.2e1) / 0.2e1 +
+                                                                                                                                                                     (0.1e1 - cos(0.2e1 * M_PI * dy)) *
+                                                                                                                                                                     pow(M_PI, -0.2e1) / 0.2e1))) /
+                                ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) * pow(M_PI, -0.2e1) / 0.2e1)
+                                - sD->A * sin(0.2e1 * M_PI * dx) * pow(M_PI, -0.2e1) * sin(0.2e1 * M_PI * dy) * (pow(M_E, -sD->KASQR * ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 +
+                                                                                                                                        (0.1e1 - cos(0.2e1 * M_PI * dy)) * pow(M_PI, -0.2e1) / 0.2e1)) *
+                                                                                                                 sD->KASQR * sin(0.2e1 * M_PI * dx) / M_PI * log(M_E) / ((0.1e1 - cos(0.2e1 * M_PI * dx)) *
+                                                                                                                                                                         pow(M_PI, -0.2e1) / 0.2e1 +
+                                                                                                                                                                         (0.1e1 - cos(0.2e1 * M_PI * dy)) *
+                                                                                                                                                                         pow(M_PI, -0.2e1) / 0.2e1) -
+                                                                                                                 (0.1e1 - pow(M_E, -sD->KASQR * ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) /
+                                                                                                                                                 0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) *
+                                                                                                                                                 pow(M_PI, -0.2e1) / 0.2e1))) *
+                                                                                                                 pow((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 +
+                                                                                                                     (0.1e1 - cos(0.2e1 * M_PI * dy)) * pow(M_PI, -0.2e1) / 0.2e1, -0.2e1) *
+                                                                                                                 sin(0.2e1 * M_PI * dx) / M_PI + sD->KASQR * sD->KASQR * pow(M_E, -sD->KASQR *
+                                                                                                                                                                             ((0.1e1 - cos(0.2e1 * M_PI * dx)) *
+                                                                                                                                                                              pow(M_PI, -0.2e1) /
+                                                                                                                                                                              0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) *
+                                                                                                                                                                              pow(M_PI, -0.2e1) / 0.2e1)) *
+                                                                                                                 sin(0.2e1 * M_PI * dx) / M_PI * log(M_E)) / ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) /
+                                                                                                                                                              0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) *
+                                                                                                                                                              pow(M_PI, -0.2e1) / 0.2e1) / 0.2e1 + sD->A *
+                                pow(sin(0.2e1 * M_PI * dx), 0.2e1) * pow(M_PI, -0.3e1) * sin(0.2e1 * M_PI * dy) * ((0.1e1 - pow(M_E, -sD->KASQR * ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 +
+                                                                                                                                                   (0.1e1 - cos(0.2e1 * M_PI * dy)) * pow(M_PI, -0.2e1) / 0.2e1))) /
+                                                                                                                   ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) *
+                                                                                                                    pow(M_PI, -0.2e1) / 0.2e1) - sD->KASQR * pow(M_E, -sD->KASQR * ((0.1e1 - cos(0.2e1 * M_PI * dx)) *
+                                                                                                                                                                                    pow(M_PI, -0.2e1) / 0.2e1 +
+                                                                                                                                                                                    (0.1e1 - cos(0.2e1 * M_PI * dy)) *
+                                                                                                                                                                                    pow(M_PI, -0.2e1) / 0.2e1))) *
+                                pow((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) * pow(M_PI, -0.2e1) / 0.2e1, -0.2e1) / 0.2e1) *  multiplier;
+        }
+    }
+    return tmp;
+}
+
+void Simulation::calculateJacobian(IntegratorWorkspace &ws, const double & stepsize, const std::vector<Dislocation> & data, double gamma)
 {
     int totalElementCounter = 0;
 
     for (unsigned int j = 0; j < sD->dc; j++)
     {
-        if (sD->currentStorageSize - totalElementCounter < sD->dc)
+        if (ws.currentStorageSize - totalElementCounter < sD->dc)
         {
-               double * tmp = static_cast<double*>(realloc(sD->Ax, (sD->currentStorageSize + sD->dc) * sizeof(double)));
-               //std::cout << "Used percent: " << double(sD->currentStorageSize) / double(sD->dc) / double(sD->dc) << std::endl;
+               double * tmp = static_cast<double*>(realloc(ws.Ax, (ws.currentStorageSize + sD->dc) * sizeof(double)));
+               //std::cout << "Used percent: " << double(ws.currentStorageSize) / double(sD->dc) / double(sD->dc) << std::endl;
                if (tmp == nullptr)
                {
                    std::cerr << "Out of memory to allocate more memory. Exit to prevent corrupted data." << std::endl;
                    exit(-4);
                }
 
-               sD->Ax = tmp;
-               sD->currentStorageSize += sD->dc;
-               for (unsigned int i = totalElementCounter; i < sD->currentStorageSize; i++)
+               ws.Ax = tmp;
+               ws.currentStorageSize += sD->dc;
+               for (unsigned int i = totalElementCounter; i < ws.currentStorageSize; i++)
                {
-                   sD->Ax[i] = 0.0;
+                   ws.Ax[i] = 0.0;
                }
         }
         // Previously calculated part
         for (unsigned int i = 0; i < j; i++)
         {
-            double v = getElement(j, sD->Ap[i], sD->Ap[i+1]);
+            double v = getElement(ws, j, ws.Ap[i], ws.Ap[i+1]);
             if (v != 0.0)
             {
-                sD->Ai[totalElementCounter] = i;
-                sD->Ax[totalElementCounter++] = v;
+                ws.Ai[totalElementCounter] = i;
+                ws.Ax[totalElementCounter++] = v;
             }
         }
         // Add the diagonal element (it will be calculated later and the point defects now)
-        sD->Ai[totalElementCounter] = j;
-        double tmp = 0;
+        ws.Ai[totalElementCounter] = j;
+        double tmp = calculatePointDefectJacobianDiagonal(data[j]);
         double dx;
         double dy;
-        for (size_t l = 0; l < sD->pc; l++)
-        {
-            dx = data[j].x - sD->points[l].x;
-            normalize(dx);
-            dy = data[j].y - sD->points[l].y;
-            normalize(dy);
-
-            if (pow(sqrt(dx * dx + dy * dy) - sD->cutOff, 2) < 36.8 * sD->cutOffSqr)
-            {
-                double multiplier = 1;
-                if (dx * dx + dy * dy > sD->cutOffSqr)
-                {
-                    multiplier = exp(-pow(sqrt(dx*dx+dy*dy)-sD->cutOff, 2) * sD->onePerCutOffSqr);
-                }
-                tmp -= data[j].b * (- sD->A * cos(0.2e1 * M_PI * dx) / M_PI * sin(0.2e1 * M_PI * dy) * ((0.1e1 - pow(M_E, -sD->KASQR * ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 +
-                                                                                                                                        (0.1e1 - cos(0.2e1 * M_PI * dy)) * pow(M_PI, -0.2e1) / 0.2e1))) /
-                                                                                                        ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) *
-                                                                                                         pow(M_PI, -0.2e1) / 0.2e1) - sD->KASQR * pow(M_E, -sD->KASQR * ((0.1e1 - cos(0.2e1 * M_PI * dx)) *
-                                                                                                                                                                         pow(M_PI, -0.2e1) / 0.2e1 +
-                                                                                                                                                                         (0.1e1 - cos(0.2e1 * M_PI * dy)) *
-                                                                                                                                                                         pow(M_PI, -0.2e1) / 0.2e1))) /
-                                    ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) * pow(M_PI, -0.2e1) / 0.2e1)
-                                    - sD->A * sin(0.2e1 * M_PI * dx) * pow(M_PI, -0.2e1) * sin(0.2e1 * M_PI * dy) * (pow(M_E, -sD->KASQR * ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 +
-                                                                                                                                            (0.1e1 - cos(0.2e1 * M_PI * dy)) * pow(M_PI, -0.2e1) / 0.2e1)) *
-                                                                                                                     sD->KASQR * sin(0.2e1 * M_PI * dx) / M_PI * log(M_E) / ((0.1e1 - cos(0.2e1 * M_PI * dx)) *
-                                                                                                                                                                             pow(M_PI, -0.2e1) / 0.2e1 +
-                                                                                                                                                                             (0.1e1 - cos(0.2e1 * M_PI * dy)) *
-                                                                                                                                                                             pow(M_PI, -0.2e1) / 0.2e1) -
-                                                                                                                     (0.1e1 - pow(M_E, -sD->KASQR * ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) /
-                                                                                                                                                     0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) *
-                                                                                                                                                     pow(M_PI, -0.2e1) / 0.2e1))) *
-                                                                                                                     pow((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 +
-                                                                                                                         (0.1e1 - cos(0.2e1 * M_PI * dy)) * pow(M_PI, -0.2e1) / 0.2e1, -0.2e1) *
-                                                                                                                     sin(0.2e1 * M_PI * dx) / M_PI + sD->KASQR * sD->KASQR * pow(M_E, -sD->KASQR *
-                                                                                                                                                                                 ((0.1e1 - cos(0.2e1 * M_PI * dx)) *
-                                                                                                                                                                                  pow(M_PI, -0.2e1) /
-                                                                                                                                                                                  0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) *
-                                                                                                                                                                                  pow(M_PI, -0.2e1) / 0.2e1)) *
-                                                                                                                     sin(0.2e1 * M_PI * dx) / M_PI * log(M_E)) / ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) /
-                                                                                                                                                                  0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) *
-                                                                                                                                                                  pow(M_PI, -0.2e1) / 0.2e1) / 0.2e1 + sD->A *
-                                    pow(sin(0.2e1 * M_PI * dx), 0.2e1) * pow(M_PI, -0.3e1) * sin(0.2e1 * M_PI * dy) * ((0.1e1 - pow(M_E, -sD->KASQR * ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 +
-                                                                                                                                                       (0.1e1 - cos(0.2e1 * M_PI * dy)) * pow(M_PI, -0.2e1) / 0.2e1))) /
-                                                                                                                       ((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) *
-                                                                                                                        pow(M_PI, -0.2e1) / 0.2e1) - sD->KASQR * pow(M_E, -sD->KASQR * ((0.1e1 - cos(0.2e1 * M_PI * dx)) *
-                                                                                                                                                                                        pow(M_PI, -0.2e1) / 0.2e1 +
-                                                                                                                                                                                        (0.1e1 - cos(0.2e1 * M_PI * dy)) *
-                                                                                                                                                                                        pow(M_PI, -0.2e1) / 0.2e1))) *
-                                    pow((0.1e1 - cos(0.2e1 * M_PI * dx)) * pow(M_PI, -0.2e1) / 0.2e1 + (0.1e1 - cos(0.2e1 * M_PI * dy)) * pow(M_PI, -0.2e1) / 0.2e1, -0.2e1) / 0.2e1) *  multiplier;
-            }
-        }
-        sD->Ax[totalElementCounter++] = - tmp * stepsize;
+        ws.Ax[totalElementCounter++] = - tmp * stepsize;
         // Totally new part
         for (unsigned int i = j+1; i < sD->dc; i++)
         {
@@ -339,60 +608,61 @@ void Simulation::calculateJacobian(const double & stepsize, const std::vector<Di
                 {
                     multiplier = exp(-pow(sqrt(dx*dx+dy*dy)-sD->cutOff, 2) * sD->onePerCutOffSqr);
                 }
-                sD->Ai[totalElementCounter] = i;
-                sD->Ax[totalElementCounter++] = stepsize * data[i].b * data[j].b * sD->tau->xy_diff_x(dx, dy) * multiplier;
+                ws.Ai[totalElementCounter] = i;
+                ws.Ax[totalElementCounter++] = stepsize * data[i].b * data[j].b * sD->tau->xy_diff_x(dx, dy) * multiplier;
             }
         }
-        sD->Ap[j+1] = totalElementCounter;
+        ws.Ap[j+1] = totalElementCounter;
     }
 
     for (unsigned int j = 0; j < sD->dc; j++)
     {
         double subSum = 0;
-        for (int i = sD->Ap[j]; i < sD->Ap[j+1]; i++)
+        for (int i = ws.Ap[j]; i < ws.Ap[j+1]; i++)
         {
-            if (sD->Ai[i] == int(j))
+            if (ws.Ai[i] == int(j))
             {
-                sD->indexes[j] = i;
+                ws.indexes[j] = i;
             }
-            subSum += sD->Ax[i];
+            subSum += ws.Ax[i];
         }
 
         subSum *= -1.;
-        sD->Ax[sD->indexes[j]] = subSum;
+        ws.Ax[ws.indexes[j]] = subSum;
         if (subSum > 0)
         {
             subSum = 1./subSum;
             subSum += 1.;
             subSum *= subSum;
-            sD->dVec[j] = 1./subSum;
+            ws.dVec[j] = 1./subSum;
         }
         else
         {
-            sD->dVec[j] = 0.;
+            ws.dVec[j] = 0.;
         }
     }
 
+    // If gamma is given, the matrix is I - gamma * stepsize * J as in Rosenbrock methods
     for (unsigned int j = 0; j < sD->dc; j++)
     {
-        for (int i = sD->Ap[j]; i < sD->Ap[j+1]; i++)
+        for (int i = ws.Ap[j]; i < ws.Ap[j+1]; i++)
         {
-            sD->Ax[i] *= (1.0+sD->dVec[sD->Ai[i]]) * 0.5;
+            ws.Ax[i] *= gamma > 0 ? gamma : (1.0+ws.dVec[ws.Ai[i]]) * 0.5;
         }
-        sD->Ax[sD->indexes[j]] += 1.0;
+        ws.Ax[ws.indexes[j]] += 1.0;
     }
 }
 
-void Simulation::calculateSparseFormForJacobian()
+void Simulation::calculateSparseFormForJacobian(IntegratorWorkspace &ws)
 {
-    (void) umfpack_di_symbolic (sD->dc, sD->dc, sD->Ap, sD->Ai, sD->Ax, &(sD->Symbolic), sD->null, sD->null);
-    (void) umfpack_di_numeric (sD->Ap, sD->Ai, sD->Ax, sD->Symbolic, &(sD->Numeric), sD->null, sD->null);
-    umfpack_di_free_symbolic (&(sD->Symbolic));
+    (void) umfpack_di_symbolic (ws.g.size(), ws.g.size(), ws.Ap, ws.Ai, ws.Ax, &(ws.Symbolic), ws.null, ws.null);
+    (void) umfpack_di_numeric (ws.Ap, ws.Ai, ws.Ax, ws.Symbolic, &(ws.Numeric), ws.null, ws.null);
+    umfpack_di_free_symbolic (&(ws.Symbolic));
 }
 
-void Simulation::solveEQSys()
+void Simulation::solveEQSys(IntegratorWorkspace &ws)
 {
-    (void) umfpack_di_solve (UMFPACK_A, sD->Ap, sD->Ai, sD->Ax, sD->x, sD->g.data(), sD->Numeric, sD->null, sD->null) ;
+    (void) umfpack_di_solve (UMFPACK_A, ws.Ap, ws.Ai, ws.Ax, ws.x, ws.g.data(), ws.Numeric, ws.null, ws.null) ;
 }
 
 void Simulation::calculateXError()
@@ -400,6 +670,12 @@ void Simulation::calculateXError()
     for (size_t i = 0; i < sD->dc; i++)
     {
         double tmp = fabs(sD->bigStep[i].x - sD->secondSmall[i].x);
+
+        // The extrapolated result is more precise than the half steps, so the error of the latter is a safe estimate
+        if (isExtrapolated(i))
+        {
+            tmp /= RICHARDSON_ERROR_DIVISOR;
+        }
         pH->updateError(tmp, i);
     }
 }
@@ -416,6 +692,12 @@ double Simulation::calculateOrderParameter(const std::vector<double> &speeds)
 
 void Simulation::run()
 {
+    if (!sD->checkpointPath.empty())
+    {
+        installCheckpointSignalHandler();
+    }
+
+    bool terminated = false;
     while( ((sD->isTimeLimit && sD->simTime < sD->timeLimit) || !sD->isTimeLimit) &&
            ((sD->isStrainIncreaseLimit && sD->totalAccumulatedStrainIncrease < sD->totalAccumulatedStrainIncreaseLimit) || !sD->isStrainIncreaseLimit) &&
            ((sD->isStepCountLimit && sD->succesfulSteps < sD->stepCountLimit) || !sD->isStepCountLimit) &&
@@ -423,24 +705,123 @@ void Simulation::run()
            !sD->finish
            )
     {
-        step();
+        // The checkpoints are written only after successful steps, so there is no half finished step to save
+        if (!step() || sD->checkpointPath.empty())
+        {
+            continue;
+        }
+
+        if (isCheckpointSignalReceived())
+        {
+            writeCheckpoint(sD->checkpointPath);
+            std::cout << "Stopped by SIGTERM at " << sD->simTime << ", checkpoint is written to " << sD->checkpointPath << "\n";
+            terminated = true;
+            break;
+        }
+
+        if (sD->checkpointInterval > 0 && sD->succesfulSteps % sD->checkpointInterval == 0)
+        {
+            writeCheckpoint(sD->checkpointPath);
+        }
     }
-    while(sD->remainingFinalSteps > 0) {
+    // A terminated run is continued from the checkpoint, only its outputs are finished
+    while(!terminated && sD->remainingFinalSteps > 0) {
         sD->inFinal = true;
         step();
     }
-    sD->writeDislocationDataToFile(sD->endDislocationConfigurationPath);
+
+    subConfigWriter.flush();
+    if (logAggregator)
+    {
+        if (const double * window = logAggregator->finish())
+        {
+            writeAggregatedLogRow(window);
+        }
+    }
+    if (sD->binaryLog)
+    {
+        sD->binaryLog->flush();
+    }
+    sD->subConfigQueueMaxDepth = subConfigWriter.getMaxDepth();
+    sD->subConfigBlockedTime = subConfigWriter.getBlockedTime();
+    if (sD->isSaveSubConfigs)
+    {
+        std::cout << "Sub-configuration queue: max depth " << sD->subConfigQueueMaxDepth << "/" << sD->subConfigQueueSize
+                  << ", blocked for " << sD->subConfigBlockedTime << " s\n";
+    }
+
+    if (!terminated)
+    {
+        sD->writeDislocationDataToFile(sD->endDislocationConfigurationPath);
+    }
 }
 
 bool Simulation::step()
 {
-    stepStageI();
-    stepStageII();
-    stepStageIII();
+    size_t heapAllocations = getHeapAllocationCount();
+
+    // The parser checks it, but from python the extrapolation can be turned on with any integrator
+    if (sD->richardsonExtrapolation && sD->integrator != TrapezoidalStepDoubling)
+    {
+        std::cerr << "richardson-extrapolation can be used only with the trapezoidal integrator!\n";
+        exit(-1);
+    }
+
+    // The predictor of the embedded error estimate needs the speeds of the previous step
+    if (sD->integrator == RosenbrockW)
+    {
+        stepRosenbrock();
+    }
+    else if (sD->integrator == TrapezoidalEmbedded && lastStepSize > 0)
+    {
+        stepEmbedded();
+    }
+    else if (sD->speculativeTrials > 1 && sD->integrator == TrapezoidalStepDoubling)
+    {
+        stepSpeculative();
+    }
+    else
+    {
+        if (sD->concurrentStages)
+        {
+            stepStagesIAndII();
+        }
+        else
+        {
+            stepStageI();
+            stepStageII();
+        }
+        stepStageIII();
+    }
+
+    sD->stepHeapAllocations = getHeapAllocationCount() - heapAllocations;
     return succesfulStep;
 }
 
 void Simulation::stepStageI()
+{
+    beginStep();
+    integrateBigStep();
+}
+
+void Simulation::stepStagesIAndII()
+{
+    beginStep();
+
+    // The first small step needs the initial speeds, so they have to be ready before it is started
+    if (initSpeedCalculationIsNeeded || bigStepIsReady)
+    {
+        integrateBigStep();
+        stepStageII();
+        return;
+    }
+
+    std::thread firstSmallStep(&Simulation::stepStageII, this);
+    integrateBigStep();
+    firstSmallStep.join();
+}
+
+void Simulation::beginStep()
 {
     energyAccum = 0;
 
@@ -450,8 +831,8 @@ void Simulation::stepStageI()
     if (firstStepRequest)
     {
         lastWriteTimeFinished = get_wall_time();
-        if (sD->externalStressProtocol->getType() == "spring-stress") {
-            static_cast<sdddstCore::SpringProtocol*>(sD->externalStressProtocol.get())->calculateStress(sD->simTime, sD->dislocations, sdddstCore::StressProtocolStepType::Original, sD->totalAccumulatedStrainIncrease);
+        if (SpringProtocol * spring = getSpringProtocol()) {
+            spring->calculateStress(sD->simTime, sD->dislocations, sdddstCore::StressProtocolStepType::Original, sD->totalAccumulatedStrainIncrease);
         } else {
             sD->externalStressProtocol->calculateStress(sD->simTime, sD->dislocations, sdddstCore::StressProtocolStepType::Original);
         }
@@ -460,32 +841,71 @@ void Simulation::stepStageI()
         sumAvgSp = std::accumulate(sD->initSpeed.begin(), sD->initSpeed.end(), 0.0, [](double a, double b){return a + fabs(b);}) / double(sD->dc);
         vsquare = std::accumulate(sD->initSpeed.begin(), sD->initSpeed.end(), 0.0, [](double a, double b){return a + b*b;});
 
-        // First log line
-        sD->standardOutputLog <<
-                                 sD->simTime << " " <<
-                                 sD->succesfulSteps << " " <<
-                                 sD->failedSteps << " " <<
-                                 0 << " " <<
-                                 sumAvgSp << " " <<
-                                 sD->cutOff << " " <<
-                                 "-" << " " <<
-                                 sD->externalStressProtocol->getStress(sD->currentStressStateType) << " " <<
-                                 "-" << " " <<
-                                 sD->totalAccumulatedStrainIncrease << " " <<
-                                 vsquare << " " <<
-                                 energy << "\n";
+        // First log line, the columns are set in the constructor (the iteration count is the last one, it is used only if it is logged)
+        double row[] = {sD->simTime, double(sD->succesfulSteps), double(sD->failedSteps), 0, sumAvgSp, sD->cutOff, NAN,
+                        sD->externalStressProtocol->getStress(sD->currentStressStateType), NAN,
+                        sD->totalAccumulatedStrainIncrease, vsquare, energy, 0};
+        if (logAggregator && logAggregator->isWindowed())
+        {
+            writeAggregatedLogRow(logAggregator->addInitialRow(row));
+        }
+        else if (sD->binaryLog)
+        {
+            sD->binaryLog->addRow(row);
+        }
+        else
+        {
+            sD->standardOutputLog <<
+                                     sD->simTime << " " <<
+                                     sD->succesfulSteps << " " <<
+                                     sD->failedSteps << " " <<
+                                     0 << " " <<
+                                     sumAvgSp << " " <<
+                                     sD->cutOff << " " <<
+                                     "-" << " " <<
+                                     sD->externalStressProtocol->getStress(sD->currentStressStateType) << " " <<
+                                     "-" << " " <<
+                                     sD->totalAccumulatedStrainIncrease << " " <<
+                                     vsquare << " " <<
+                                     energy;
+            if (sD->isNewtonConvergenceControlled)
+            {
+                sD->standardOutputLog << " " << 0;
+            }
+            sD->standardOutputLog << "\n";
+        }
 
         firstStepRequest = false;
     }
+}
+
+void Simulation::integrateBigStep()
+{
+    // The first small step of the rejected step is exactly the big step of this one
+    if (bigStepIsReady)
+    {
+        bigStepIsReady = false;
+        sD->reusedHalfSteps++;
+        succesfulStep = false;
+        return;
+    }
 
-    // Reset the variables for the integration
-    sD->bigStep = sD->dislocations;
+    // The buffer of the big step is initialized by the predictor or by the first Newton iteration
+    if (sD->predictorOrder > 0)
+    {
+        if (initSpeedCalculationIsNeeded)
+        {
+            calculateInitSpeed(sD->bigStepWorkspace, sD->dislocations, sD->initSpeed, Original);
+            initSpeedCalculationIsNeeded = false;
+        }
+        predict(sD->bigStep, sD->dislocations, sD->initSpeed, lastInitSpeed, lastStepSize, sD->stepSize, sD->predictorOrder);
+    }
 
 
     /////////////////////////////////
     /// Integrating procedure begins
 
-    integrate(sD->stepSize, sD->bigStep, sD->dislocations, false, initSpeedCalculationIsNeeded, Original, EndOfBigStep);
+    integrate(sD->bigStepWorkspace, sD->stepSize, sD->bigStep, sD->dislocations, false, initSpeedCalculationIsNeeded, Original, EndOfBigStep, sD->predictorOrder == 0);
 
     // This can not get before the first integration step
     succesfulStep = false;
@@ -493,65 +913,878 @@ void Simulation::stepStageI()
 
 void Simulation::stepStageII()
 {
-    sD->firstSmall = sD->dislocations;
+    if (sD->predictorOrder > 0)
+    {
+        predict(sD->firstSmall, sD->dislocations, sD->initSpeed, lastInitSpeed, lastStepSize, 0.5 * sD->stepSize, sD->predictorOrder);
+    }
 
-    integrate(0.5*sD->stepSize, sD->firstSmall, sD->dislocations, false, false, Original, EndOfFirstSmallStep);
+    integrate(sD->smallStepWorkspace, 0.5*sD->stepSize, sD->firstSmall, sD->dislocations, false, false, Original, EndOfFirstSmallStep, sD->predictorOrder == 0);
 }
 
 void Simulation::stepStageIII()
+{
+    estimateStepError();
+    finishStep(sD->secondSmall, &sD->firstSmall, sD->smallStepWorkspace.speed, vsquare2, 0.5 * sD->stepSize);
+}
+
+void Simulation::estimateStepError()
 {
     sD->sumAvgSpeed = 0;
-    sD->secondSmall = sD->firstSmall;
 
-    integrate(0.5 * sD->stepSize, sD->secondSmall, sD->firstSmall, true, true, EndOfFirstSmallStep, EndOfSecondSmallStep);
+    if (sD->predictorOrder > 0)
+    {
+        // The speeds at the start of the step give the acceleration for the second half
+        calculateInitSpeed(sD->bigStepWorkspace, sD->firstSmall, sD->initSpeed2, EndOfFirstSmallStep);
+        predict(sD->secondSmall, sD->firstSmall, sD->initSpeed2, sD->initSpeed, 0.5 * sD->stepSize, 0.5 * sD->stepSize, sD->predictorOrder);
+        integrate(sD->bigStepWorkspace, 0.5 * sD->stepSize, sD->secondSmall, sD->firstSmall, true, false, EndOfFirstSmallStep, EndOfSecondSmallStep);
+    }
+    else
+    {
+        integrate(sD->bigStepWorkspace, 0.5 * sD->stepSize, sD->secondSmall, sD->firstSmall, true, true, EndOfFirstSmallStep, EndOfSecondSmallStep, true);
+    }
 
     vsquare1 = std::accumulate(sD->initSpeed.begin(), sD->initSpeed.end(), 0.0, [](double a, double b){return a + b*b;});
     vsquare2 = std::accumulate(sD->initSpeed2.begin(), sD->initSpeed2.end(), 0.0, [](double a, double b){return a + b*b;});
 
     energyAccum = (vsquare1+vsquare2) * 0.5 * sD->stepSize * 0.5;
 
+    pH->mergeTolerance(sD->bigStepWorkspace.tolerance);
+    pH->mergeTolerance(sD->smallStepWorkspace.tolerance);
+
     calculateXError();
 
-    /// Precision related error handling
-    if (pH->getMaxErrorRatioSqr() < 1.0)
+    if (sD->isDipoleTreatment)
     {
-        succesfulStep = true;
-        initSpeedCalculationIsNeeded = true;
-        if (sD->inFinal) {
-            sD->remainingFinalSteps--;
-        }
-
-        if (sD->calculateStrainDuringSimulation)
-        {
-            sD->totalAccumulatedStrainIncrease += calculateStrainIncrement(sD->dislocations, sD->firstSmall);
-            sD->totalAccumulatedStrainIncrease += calculateStrainIncrement(sD->firstSmall, sD->secondSmall);
-        }
+        detectDipoles();
+    }
 
-        sD->dislocations.swap(sD->secondSmall);
+    // If only a few dislocations missed the precision (or they are bound in dipoles), only they are integrated again with smaller steps
+    fastIDs.clear();
+    if (((sD->multirateMaxSubsteps > 1 && pH->getMaxErrorRatioSqr() >= 1.0) || !boundPairs.empty()) &&
+            !sD->bigStepWorkspace.newtonFailed && !sD->smallStepWorkspace.newtonFailed)
+    {
+        stepFastDislocations();
+    }
 
-        sD->simTime += sD->stepSize;
-        sD->succesfulSteps++;
+    if (sD->richardsonExtrapolation)
+    {
+        extrapolateSecondSmallStep();
+    }
+}
 
-        double orderParameter = 0;
-        if (sD->orderParameterCalculationIsOn)
+void Simulation::extrapolateSecondSmallStep()
+{
+    double strainChange = 0;
+    for (unsigned int i = 0; i < sD->dc; i++)
+    {
+        if (!isExtrapolated(i) || std::binary_search(fastIDs.begin(), fastIDs.end(), i))
         {
-            orderParameter = calculateOrderParameter(sD->speed);
+            continue;
         }
+        double correction = (sD->secondSmall[i].x - sD->bigStep[i].x) / RICHARDSON_ERROR_DIVISOR;
+        sD->secondSmall[i].x += correction;
+        strainChange += sD->secondSmall[i].b * correction;
+    }
+    sD->secondSmallStrainIncrement += strainChange;
+}
 
-        double current_wall_time = get_wall_time();
+bool Simulation::isExtrapolated(unsigned int i) const
+{
+    // The big step is damped the most, the half steps are checked as well in case the big step was reused
+    return sD->richardsonExtrapolation &&
+            std::max(sD->bigStepWorkspace.dVec[i], sD->smallStepWorkspace.dVec[i]) < RICHARDSON_MAX_DAMPING;
+}
 
-        sD->currentStressStateType = Original;
-        if (sD->externalStressProtocol->getType() == "spring-stress") {
-            static_cast<sdddstCore::SpringProtocol*>(sD->externalStressProtocol.get())->calculateStress(sD->simTime, sD->dislocations, Original, sD->totalAccumulatedStrainIncrease);
-        } else {
-            sD->externalStressProtocol->calculateStress(sD->simTime, sD->dislocations, Original);
-        }
-        calculateSpeeds(sD->dislocations, sD->initSpeed);
-        initSpeedCalculationIsNeeded = false;
-        sD->sumAvgSpeed = std::accumulate(sD->initSpeed.begin(), sD->initSpeed.end(), 0.0, [](double a, double b){return a + fabs(b);}) / double(sD->dc);
+void Simulation::attemptStep()
+{
+    if (sD->concurrentStages)
+    {
+        stepStagesIAndII();
+    }
+    else
+    {
+        stepStageI();
+        stepStageII();
+    }
+    estimateStepError();
+}
 
-        if (sD->sumAvgSpeed < sD->speedLimit && sD->isSpeedLimit) {
-            sD->finish = true;
+bool Simulation::attemptIsAccepted() const
+{
+    return !sD->bigStepWorkspace.newtonFailed && !sD->smallStepWorkspace.newtonFailed && pH->getMaxErrorRatioSqr() < 1.0;
+}
+
+void Simulation::stepSpeculative()
+{
+    // The trials do not share the dipole and the half step bookkeeping (the parser checks it, but python can set them)
+    if (sD->isDipoleTreatment || sD->reuseHalfStep)
+    {
+        std::cerr << "speculative-trials can not be used with reuse-half-step or dipole-distance!\n";
+        exit(-1);
+    }
+
+    beginStep();
+    if (initSpeedCalculationIsNeeded)
+    {
+        calculateInitSpeed(sD->bigStepWorkspace, sD->dislocations, sD->initSpeed, Original);
+        initSpeedCalculationIsNeeded = false;
+    }
+
+    // Every trial has its own data, they start from the same state with halved step sizes
+    while (trials.size() + 1 < sD->speculativeTrials)
+    {
+        std::shared_ptr<SimulationData> trialData(new SimulationData);
+        trialData->copyRunConstants(*sD);
+        trialData->copyStepState(*sD);
+        trials.push_back(std::unique_ptr<Simulation>(new Simulation(trialData)));
+    }
+
+    std::vector<std::thread> threads;
+    double trialStepSize = sD->stepSize;
+    for (auto & trial: trials)
+    {
+        trialStepSize *= 0.5;
+        trial->sD->copyStepState(*sD);
+        trial->sD->stepSize = trialStepSize;
+        trial->sD->multirateSteps = 0;
+        trial->pH->reset();
+        trial->firstStepRequest = false;
+        trial->initSpeedCalculationIsNeeded = false;
+        trial->lastInitSpeed = lastInitSpeed;
+        trial->lastStepSize = lastStepSize;
+        threads.push_back(std::thread(&Simulation::attemptStep, trial.get()));
+    }
+    attemptStep();
+    for (auto & t: threads)
+    {
+        t.join();
+    }
+
+    // The work of every trial is counted
+    for (auto & trial: trials)
+    {
+        sD->bigStepWorkspace.iterationCount += trial->sD->bigStepWorkspace.iterationCount + trial->sD->smallStepWorkspace.iterationCount;
+    }
+
+    // The largest accepted step size is used, if none of them is accepted the smallest one is rejected as usual
+    if (!attemptIsAccepted())
+    {
+        size_t selected = 0;
+        while (selected + 1 < trials.size() && !trials[selected]->attemptIsAccepted())
+        {
+            selected++;
+        }
+        sD->failedSteps += selected + 1;
+
+        Simulation & trial = *trials[selected];
+        sD->stepSize = trial.sD->stepSize;
+        sD->bigStep.swap(trial.sD->bigStep);
+        sD->firstSmall.swap(trial.sD->firstSmall);
+        sD->secondSmall.swap(trial.sD->secondSmall);
+        sD->bigStepStrainIncrement = trial.sD->bigStepStrainIncrement;
+        sD->firstSmallStrainIncrement = trial.sD->firstSmallStrainIncrement;
+        sD->secondSmallStrainIncrement = trial.sD->secondSmallStrainIncrement;
+        sD->initSpeed2.swap(trial.sD->initSpeed2);
+        sD->smallStepWorkspace.speed.swap(trial.sD->smallStepWorkspace.speed);
+        sD->bigStepWorkspace.newtonFailed = trial.sD->bigStepWorkspace.newtonFailed;
+        sD->smallStepWorkspace.newtonFailed = trial.sD->smallStepWorkspace.newtonFailed;
+        sD->multirateSteps += trial.sD->multirateSteps;
+        pH.swap(trial.pH);
+        vsquare1 = trial.vsquare1;
+        vsquare2 = trial.vsquare2;
+        energyAccum = trial.energyAccum;
+    }
+
+    finishStep(sD->secondSmall, &sD->firstSmall, sD->smallStepWorkspace.speed, vsquare2, 0.5 * sD->stepSize);
+}
+
+void Simulation::stepEmbedded()
+{
+    sD->sumAvgSpeed = 0;
+    beginStep();
+
+    if (initSpeedCalculationIsNeeded)
+    {
+        calculateInitSpeed(sD->bigStepWorkspace, sD->dislocations, sD->initSpeed, Original);
+        initSpeedCalculationIsNeeded = false;
+    }
+
+    // Explicit second order (Adams-Bashforth type) predictor, it is the NR initial guess as well
+    predict(sD->firstSmall, sD->dislocations, sD->initSpeed, lastInitSpeed, lastStepSize, sD->stepSize, 2);
+    sD->bigStep = sD->firstSmall;
+
+    integrate(sD->bigStepWorkspace, sD->stepSize, sD->bigStep, sD->dislocations, false, false, Original, EndOfBigStep);
+    succesfulStep = false;
+
+    vsquare1 = std::accumulate(sD->initSpeed.begin(), sD->initSpeed.end(), 0.0, [](double a, double b){return a + b*b;});
+    energyAccum = 0;
+
+    pH->mergeTolerance(sD->bigStepWorkspace.tolerance);
+
+    // Milne's device: the local error of the trapezoidal rule is about the sixth of the predictor-corrector difference
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        pH->updateError(fabs(sD->bigStep[i].x - sD->firstSmall[i].x) / 6.0, i);
+    }
+
+    finishStep(sD->bigStep, nullptr, sD->bigStepWorkspace.speed, vsquare1, sD->stepSize);
+}
+
+void Simulation::stepRosenbrock()
+{
+    sD->sumAvgSpeed = 0;
+    beginStep();
+
+    IntegratorWorkspace & ws = sD->bigStepWorkspace;
+    if (initSpeedCalculationIsNeeded)
+    {
+        calculateInitSpeed(ws, sD->dislocations, sD->initSpeed, Original);
+        initSpeedCalculationIsNeeded = false;
+    }
+
+    ws.stages.resize(RosenbrockTableau::stageCount);
+    for (auto & stage: ws.stages)
+    {
+        stage.resize(sD->dc);
+    }
+
+    // The same matrix is used for all of the stages, as a W-method the order does not depend on its exactness
+    calculateJacobian(ws, sD->stepSize, sD->dislocations, ros34pw2.gamma);
+    calculateSparseFormForJacobian(ws);
+
+    // The external stress depends on the time explicitly, its derivative is needed for the order of a non-autonomous system
+    double stressRate = sD->externalStressProtocol->getStressDerivative(sD->simTime);
+    if (SpringProtocol * spring = getSpringProtocol()) {
+        stressRate *= spring->getSpringConstant();
+    }
+
+    // Every stage uses its own stress slot of the protocol
+    const StressProtocolStepType slots[RosenbrockTableau::stageCount] = {Original, EndOfBigStep, EndOfFirstSmallStep, EndOfSecondSmallStep};
+    for (int s = 0; s < RosenbrockTableau::stageCount; s++)
+    {
+        const std::vector<double> * speed = &(sD->initSpeed);
+        if (s > 0)
+        {
+            sD->firstSmallStrainIncrement = 0;
+            for (size_t i = 0; i < sD->dc; i++)
+            {
+                double x = sD->dislocations[i].x;
+                for (int j = 0; j < s; j++)
+                {
+                    x += ros34pw2.a[s][j] * ws.stages[j][i];
+                }
+                sD->firstSmall[i] = sD->dislocations[i];
+                sD->firstSmall[i].x = x;
+                sD->firstSmallStrainIncrement += sD->firstSmall[i].b * (x - sD->dislocations[i].x);
+            }
+
+            double t = sD->simTime + ros34pw2.alpha[s] * sD->stepSize;
+            if (SpringProtocol * spring = getSpringProtocol()) {
+                double tasi = sD->totalAccumulatedStrainIncrease + sD->firstSmallStrainIncrement;
+                spring->calculateStress(t, sD->firstSmall, slots[s], tasi);
+            } else {
+                sD->externalStressProtocol->calculateStress(t, sD->firstSmall, slots[s]);
+            }
+            calculateSpeeds(sD->firstSmall, ws.speed, slots[s], &ws.tolerance);
+            speed = &(ws.speed);
+        }
+
+        for (size_t i = 0; i < sD->dc; i++)
+        {
+            double rhs = sD->stepSize * (*speed)[i] + ros34pw2.gammaSum[s] * sD->stepSize * sD->stepSize * sD->dislocations[i].b * stressRate;
+            for (int j = 0; j < s; j++)
+            {
+                rhs += ros34pw2.c[s][j] * ws.stages[j][i];
+            }
+            ws.g[i] = ros34pw2.gamma * rhs;
+        }
+        solveEQSys(ws);
+        std::copy(ws.x, ws.x + sD->dc, ws.stages[s].begin());
+    }
+    umfpack_di_free_numeric (&ws.Numeric);
+    succesfulStep = false;
+
+    // The tolerances of the close pairs found in the stages have to be known before the error ratios are calculated
+    pH->mergeTolerance(ws.tolerance);
+
+    sD->bigStepStrainIncrement = 0;
+    for (size_t i = 0; i < sD->dc; i++)
+    {
+        sD->bigStep[i] = sD->dislocations[i];
+        double error = 0;
+        for (int j = 0; j < RosenbrockTableau::stageCount; j++)
+        {
+            sD->bigStep[i].x += ros34pw2.m[j] * ws.stages[j][i];
+            error += ros34pw2.e[j] * ws.stages[j][i];
+        }
+        sD->bigStepStrainIncrement += sD->bigStep[i].b * (sD->bigStep[i].x - sD->dislocations[i].x);
+        if (!(error == error))
+        {
+            ws.newtonFailed = true;
+        }
+        pH->updateError(fabs(error), i);
+    }
+
+    vsquare1 = std::accumulate(sD->initSpeed.begin(), sD->initSpeed.end(), 0.0, [](double a, double b){return a + b*b;});
+    energyAccum = 0;
+
+    finishStep(sD->bigStep, nullptr, ws.speed, vsquare1, sD->stepSize);
+}
+
+bool Simulation::stepFastDislocations()
+{
+    fastIDs.clear();
+    fastIndex.assign(sD->dc, -1);
+    double maxRatioSqr = 0;
+    size_t unboundCount = 0;
+    for (unsigned int i = 0; i < sD->dc; i++)
+    {
+        double ratioSqr = pH->getErrorRatioSqr(i);
+        if (!(ratioSqr == ratioSqr))
+        {
+            return false;
+        }
+        bool bound = sD->isDipoleTreatment && isBound[i];
+        if (ratioSqr >= 1.0 || bound)
+        {
+            // Without multirate stepping the step is rejected anyway
+            if (!bound && sD->multirateMaxSubsteps < 2)
+            {
+                return false;
+            }
+            if (!bound)
+            {
+                unboundCount++;
+            }
+            fastIndex[i] = fastIDs.size();
+            fastIDs.push_back(i);
+            maxRatioSqr = std::max(maxRatioSqr, ratioSqr);
+        }
+    }
+
+    // The members of the dipoles are always integrated separately, only the others are limited
+    if (fastIDs.empty() || unboundCount > sD->multirateMaxFastRatio * sD->dc)
+    {
+        return false;
+    }
+
+    // The dipoles are precise enough with the large step, but they should not limit the next step size
+    if (maxRatioSqr < 1.0)
+    {
+        for (auto id: fastIDs)
+        {
+            pH->clearError(id);
+        }
+        return true;
+    }
+
+    unsigned int maxSubsteps = sD->multirateMaxSubsteps > 1 ? sD->multirateMaxSubsteps : DEFAULT_MULTIRATE_MAX_SUBSTEPS;
+
+    // The error is proportional to the third power of the step size
+    double neededSubsteps = ceil(pow(maxRatioSqr, 1./6.) / 0.9);
+    if (neededSubsteps > maxSubsteps)
+    {
+        return false;
+    }
+
+    unsigned int substeps = std::max(1u, static_cast<unsigned int>(neededSubsteps));
+    for (; substeps <= maxSubsteps; substeps *= 2)
+    {
+        if (integrateFastDislocations(substeps))
+        {
+            // The error of the fast dislocations is controlled by the substeps, the next step size depends only on the slow ones
+            for (auto id: fastIDs)
+            {
+                sD->secondSmallStrainIncrement += sD->secondSmall[id].b * (fastCurrent[id].x - sD->secondSmall[id].x);
+                sD->secondSmall[id].x = fastCurrent[id].x;
+                pH->clearError(id);
+            }
+            sD->multirateSteps++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Simulation::detectDipoles()
+{
+    detectedPairs.clear();
+    isBound.assign(sD->dc, false);
+    double limitSqr = sD->dipoleDistance * sD->dipoleDistance;
+    for (unsigned int i = 0; i < sD->dc; i++)
+    {
+        for (unsigned int j = i + 1; j < sD->dc; j++)
+        {
+            if (sD->dislocations[i].b * sD->dislocations[j].b > 0)
+            {
+                continue;
+            }
+
+            double dx = sD->dislocations[i].x - sD->dislocations[j].x;
+            normalize(dx);
+
+            double dy = sD->dislocations[i].y - sD->dislocations[j].y;
+            normalize(dy);
+
+            if (dx * dx + dy * dy < limitSqr)
+            {
+                detectedPairs.push_back(std::make_pair(i, j));
+                isBound[i] = true;
+                isBound[j] = true;
+            }
+        }
+    }
+
+    // Both lists are ordered, so the events can be found with binary search
+    for (const auto & p: detectedPairs)
+    {
+        if (!std::binary_search(boundPairs.begin(), boundPairs.end(), p))
+        {
+            sD->dipoleBindings++;
+            std::cout << "Dipole formed: " << p.first << " " << p.second << " at " << sD->simTime << "\n";
+        }
+    }
+    for (const auto & p: boundPairs)
+    {
+        if (!std::binary_search(detectedPairs.begin(), detectedPairs.end(), p))
+        {
+            sD->dipoleReleases++;
+            std::cout << "Dipole released: " << p.first << " " << p.second << " at " << sD->simTime << "\n";
+        }
+    }
+    boundPairs.swap(detectedPairs);
+}
+
+void Simulation::annihilateDislocations()
+{
+    annihilationCandidates.clear();
+    double limitSqr = sD->annihilationDistance * sD->annihilationDistance;
+    for (unsigned int i = 0; i < sD->dc; i++)
+    {
+        for (unsigned int j = i + 1; j < sD->dc; j++)
+        {
+            if (sD->dislocations[i].b * sD->dislocations[j].b > 0)
+            {
+                continue;
+            }
+
+            double dx = sD->dislocations[i].x - sD->dislocations[j].x;
+            normalize(dx);
+
+            double dy = sD->dislocations[i].y - sD->dislocations[j].y;
+            normalize(dy);
+
+            if (dx * dx + dy * dy < limitSqr)
+            {
+                annihilationCandidates.push_back(std::make_pair(dx * dx + dy * dy, std::make_pair(i, j)));
+            }
+        }
+    }
+    if (annihilationCandidates.empty())
+    {
+        return;
+    }
+
+    // Every dislocation can be annihilated only once, the closest partner is chosen
+    std::sort(annihilationCandidates.begin(), annihilationCandidates.end());
+    annihilatedIDs.clear();
+    for (const auto & c: annihilationCandidates)
+    {
+        unsigned int i = c.second.first;
+        unsigned int j = c.second.second;
+        if (std::find(annihilatedIDs.begin(), annihilatedIDs.end(), i) != annihilatedIDs.end() ||
+                std::find(annihilatedIDs.begin(), annihilatedIDs.end(), j) != annihilatedIDs.end())
+        {
+            continue;
+        }
+        annihilatedIDs.push_back(i);
+        annihilatedIDs.push_back(j);
+        sD->annihilations++;
+        std::cout << "Annihilation: " << i << " " << j << " at " << sD->simTime << "\n";
+    }
+    std::sort(annihilatedIDs.begin(), annihilatedIDs.end());
+
+    // The IDs of the bound dipoles follow the removal, the annihilated ones are forgotten
+    if (sD->isDipoleTreatment)
+    {
+        auto newID = [this](unsigned int id) {
+            return id - static_cast<unsigned int>(std::lower_bound(annihilatedIDs.begin(), annihilatedIDs.end(), id) - annihilatedIDs.begin());
+        };
+        size_t kept = 0;
+        for (const auto & p: boundPairs)
+        {
+            if (!std::binary_search(annihilatedIDs.begin(), annihilatedIDs.end(), p.first) &&
+                    !std::binary_search(annihilatedIDs.begin(), annihilatedIDs.end(), p.second))
+            {
+                boundPairs[kept++] = std::make_pair(newID(p.first), newID(p.second));
+            }
+        }
+        boundPairs.resize(kept);
+    }
+
+    sD->removeDislocations(annihilatedIDs);
+    pH->setSize(sD->dc);
+    for (auto & trial: trials)
+    {
+        trial->pH->setSize(sD->dc);
+    }
+
+    // The speed history belongs to the old configuration
+    lastStepSize = 0;
+
+    if (sD->dc == 0)
+    {
+        sD->finish = true;
+    }
+}
+
+bool Simulation::integrateFastDislocations(unsigned int substeps)
+{
+    if (fastWorkspace.g.size() != fastIDs.size())
+    {
+        fastWorkspace.resize(fastIDs.size());
+        fastInitSpeed.resize(fastIDs.size());
+    }
+
+    double substepSize = sD->stepSize / substeps;
+    fastCurrent = sD->dislocations;
+    for (unsigned int k = 0; k < substeps; k++)
+    {
+        double startTime = sD->simTime + k * substepSize;
+
+        fastBig = fastCurrent;
+        interpolateSlowDislocations(fastBig, double(k + 1) / substeps);
+        integrateFastSubsystem(substepSize, fastBig, fastCurrent, startTime);
+
+        fastHalf = fastCurrent;
+        interpolateSlowDislocations(fastHalf, (k + 0.5) / substeps);
+        integrateFastSubsystem(0.5 * substepSize, fastHalf, fastCurrent, startTime);
+
+        fastEnd = fastHalf;
+        interpolateSlowDislocations(fastEnd, double(k + 1) / substeps);
+        integrateFastSubsystem(0.5 * substepSize, fastEnd, fastHalf, startTime + 0.5 * substepSize);
+
+        if (fastWorkspace.newtonFailed)
+        {
+            fastWorkspace.newtonFailed = false;
+            return false;
+        }
+
+        for (auto id: fastIDs)
+        {
+            double error = fabs(fastBig[id].x - fastEnd[id].x);
+            if (!(error == error) || error * error >= pH->getToleranceSqr(id))
+            {
+                return false;
+            }
+        }
+        fastCurrent.swap(fastEnd);
+    }
+    return true;
+}
+
+void Simulation::integrateFastSubsystem(const double &stepsize, std::vector<Dislocation> &newDislocation, const std::vector<Dislocation> &old, double startTime)
+{
+    IntegratorWorkspace & ws = fastWorkspace;
+    size_t fc = fastIDs.size();
+
+    calculateFastSpeeds(old, fastInitSpeed, startTime);
+    calculateFastJacobian(stepsize, newDislocation);
+    calculateSparseFormForJacobian(ws);
+
+    size_t iterationLimit = sD->ic;
+    bool converged = true;
+    double lastCorrection = 0;
+    if (sD->isNewtonConvergenceControlled)
+    {
+        iterationLimit = sD->maxIterationCount;
+        converged = false;
+    }
+
+    for (size_t i = 0; i < iterationLimit; i++)
+    {
+        calculateFastSpeeds(newDislocation, ws.speed, startTime + stepsize);
+        for (size_t a = 0; a < fc; a++)
+        {
+            unsigned int id = fastIDs[a];
+            ws.g[a] = newDislocation[id].x - (1.0+ws.dVec[a]) * 0.5 * stepsize * ws.speed[a] - old[id].x - (1.0 - ws.dVec[a]) * 0.5 * stepsize * fastInitSpeed[a];
+        }
+        (void) umfpack_di_solve (UMFPACK_A, ws.Ap, ws.Ai, ws.Ax, ws.x, ws.g.data(), ws.Numeric, ws.null, ws.null);
+
+        double correction = 0;
+        for (size_t a = 0; a < fc; a++)
+        {
+            newDislocation[fastIDs[a]].x -= ws.x[a];
+            correction = std::max(correction, fabs(ws.x[a]));
+        }
+
+        if (sD->isNewtonConvergenceControlled)
+        {
+            if (!(correction == correction) || (i > 0 && correction > lastCorrection))
+            {
+                break;
+            }
+            if (i + 1 >= sD->minIterationCount && correction < sD->newtonTolerance * sD->prec)
+            {
+                converged = true;
+                break;
+            }
+            lastCorrection = correction;
+        }
+    }
+
+    if (!converged)
+    {
+        ws.newtonFailed = true;
+    }
+    umfpack_di_free_numeric (&ws.Numeric);
+}
+
+void Simulation::calculateFastSpeeds(const std::vector<Dislocation> &dis, std::vector<double> &res, double time)
+{
+    // The big step's stress slot is free after the big step is integrated
+    if (SpringProtocol * spring = getSpringProtocol()) {
+        double tasi = sD->totalAccumulatedStrainIncrease + calculateStrainIncrement(sD->dislocations, dis);
+        spring->calculateStress(time, dis, EndOfBigStep, tasi);
+    } else {
+        sD->externalStressProtocol->calculateStress(time, dis, EndOfBigStep);
+    }
+
+    for (size_t a = 0; a < fastIDs.size(); a++)
+    {
+        unsigned int i = fastIDs[a];
+        res[a] = 0;
+        for (unsigned int j = 0; j < sD->dc; j++)
+        {
+            if (j == i)
+            {
+                continue;
+            }
+
+            double dx = dis[i].x - dis[j].x;
+            normalize(dx);
+
+            double dy = dis[i].y - dis[j].y;
+            normalize(dy);
+
+            pH->updateTolerance(dx*dx+dy*dy, i);
+            res[a] += dis[i].b * dis[j].b * sD->tau->xy(dx, dy);
+        }
+
+        for (size_t j = 0; j < sD->pc; j++)
+        {
+            double dx = dis[i].x - sD->points[j].x;
+            normalize(dx);
+
+            double dy = dis[i].y - sD->points[j].y;
+            normalize(dy);
+
+            double xSqr = X2(dx);
+            double ySqr = X2(dy);
+            double rSqr = xSqr + ySqr;
+            double expXY = exp(-sD->KASQR * rSqr);
+            res[a] -= 2.0 * sD->A * X(dx) * X(dy) * ((1.-expXY)/rSqr- sD->KASQR * expXY) / rSqr * dis[i].b;
+
+            pH->updateTolerance(rSqr, i);
+        }
+        res[a] += dis[i].b * sD->externalStressProtocol->getStress(EndOfBigStep);
+    }
+}
+
+void Simulation::calculateFastJacobian(const double &stepsize, const std::vector<Dislocation> &data)
+{
+    IntegratorWorkspace & ws = fastWorkspace;
+    size_t fc = fastIDs.size();
+
+    // The subsystem is small, so it is stored as a dense matrix in the sparse format
+    if (ws.currentStorageSize < fc * fc)
+    {
+        double * tmp = static_cast<double*>(realloc(ws.Ax, fc * fc * sizeof(double)));
+        if (tmp == nullptr)
+        {
+            std::cerr << "Out of memory to allocate more memory. Exit to prevent corrupted data." << std::endl;
+            exit(-4);
+        }
+        ws.Ax = tmp;
+        ws.currentStorageSize = fc * fc;
+    }
+
+    for (size_t b = 0; b < fc; b++)
+    {
+        unsigned int j = fastIDs[b];
+        ws.Ap[b] = b * fc;
+        ws.indexes[b] = b * fc + b;
+
+        // The diagonal contains the interactions with every other dislocation (the same way as in calculateJacobian)
+        double diagonal = calculatePointDefectJacobianDiagonal(data[j]) * stepsize;
+        for (unsigned int i = 0; i < sD->dc; i++)
+        {
+            if (i == j)
+            {
+                continue;
+            }
+            double dx = data[i].x - data[j].x;
+            normalize(dx);
+
+            double dy = data[i].y - data[j].y;
+            normalize(dy);
+
+            if (pow(sqrt(dx * dx + dy * dy) - sD->cutOff, 2) < 36.8 * sD->cutOffSqr)
+            {
+                double multiplier = 1;
+                if (dx * dx + dy * dy > sD->cutOffSqr)
+                {
+                    multiplier = exp(-pow(sqrt(dx*dx+dy*dy)-sD->cutOff, 2) * sD->onePerCutOffSqr);
+                }
+                double v = stepsize * data[i].b * data[j].b * sD->tau->xy_diff_x(dx, dy) * multiplier;
+                diagonal -= v;
+                if (fastIndex[i] >= 0)
+                {
+                    ws.Ai[b * fc + fastIndex[i]] = fastIndex[i];
+                    ws.Ax[b * fc + fastIndex[i]] = v;
+                }
+            }
+            else if (fastIndex[i] >= 0)
+            {
+                ws.Ai[b * fc + fastIndex[i]] = fastIndex[i];
+                ws.Ax[b * fc + fastIndex[i]] = 0;
+            }
+        }
+        ws.Ai[b * fc + b] = b;
+        ws.Ax[b * fc + b] = diagonal;
+
+        if (diagonal > 0)
+        {
+            double subSum = 1./diagonal + 1.;
+            ws.dVec[b] = 1./(subSum * subSum);
+        }
+        else
+        {
+            ws.dVec[b] = 0.;
+        }
+    }
+    ws.Ap[fc] = fc * fc;
+
+    for (size_t b = 0; b < fc; b++)
+    {
+        for (size_t i = b * fc; i < (b + 1) * fc; i++)
+        {
+            ws.Ax[i] *= (1.0+ws.dVec[ws.Ai[i]]) * 0.5;
+        }
+        ws.Ax[ws.indexes[b]] += 1.0;
+    }
+}
+
+void Simulation::interpolateSlowDislocations(std::vector<Dislocation> &dis, double fraction)
+{
+    for (unsigned int i = 0; i < sD->dc; i++)
+    {
+        if (fastIndex[i] < 0)
+        {
+            dis[i].x = sD->dislocations[i].x + fraction * (sD->secondSmall[i].x - sD->dislocations[i].x);
+        }
+    }
+}
+
+void Simulation::writeAggregatedLogRow(const double *values)
+{
+    if (sD->binaryLog)
+    {
+        sD->binaryLog->addRow(values);
+        return;
+    }
+
+    size_t columns = logAggregator->getOutputColumnCount();
+    for (size_t i = 0; i < columns; i++)
+    {
+        if (i > 0)
+        {
+            sD->standardOutputLog << " ";
+        }
+        if (values[i] == values[i])
+        {
+            sD->standardOutputLog << values[i];
+        }
+        else
+        {
+            sD->standardOutputLog << "-";
+        }
+    }
+    sD->standardOutputLog << "\n";
+}
+
+SpringProtocol * Simulation::getSpringProtocol() const
+{
+    return dynamic_cast<SpringProtocol*>(sD->externalStressProtocol.get());
+}
+
+void Simulation::finishStep(std::vector<Dislocation> &result, const std::vector<Dislocation> *halfway, const std::vector<double> &lastSpeed, double lastVSquare, double lastInterval)
+{
+    newtonIterations += sD->bigStepWorkspace.iterationCount + sD->smallStepWorkspace.iterationCount;
+    bool newtonFailed = sD->bigStepWorkspace.newtonFailed || sD->smallStepWorkspace.newtonFailed;
+    bool firstSmallStepFailed = sD->smallStepWorkspace.newtonFailed;
+    sD->bigStepWorkspace.iterationCount = 0;
+    sD->smallStepWorkspace.iterationCount = 0;
+    sD->bigStepWorkspace.newtonFailed = false;
+    sD->smallStepWorkspace.newtonFailed = false;
+
+    /// Precision related error handling
+    if (!newtonFailed && pH->getMaxErrorRatioSqr() < 1.0)
+    {
+        succesfulStep = true;
+        initSpeedCalculationIsNeeded = true;
+        if (sD->inFinal) {
+            sD->remainingFinalSteps--;
+        }
+
+        // The result is the second small step if the halfway state is given, otherwise the big step
+        if (sD->calculateStrainDuringSimulation && halfway)
+        {
+            sD->totalAccumulatedStrainIncrease += sD->firstSmallStrainIncrement;
+            sD->totalAccumulatedStrainIncrease += sD->secondSmallStrainIncrement;
+        }
+        else if (sD->calculateStrainDuringSimulation)
+        {
+            sD->totalAccumulatedStrainIncrease += sD->bigStepStrainIncrement;
+        }
+
+        sD->dislocations.swap(result);
+
+        if (sD->predictorOrder > 1 || sD->integrator == TrapezoidalEmbedded)
+        {
+            lastInitSpeed = sD->initSpeed;
+            lastStepSize = sD->stepSize;
+        }
+
+        sD->simTime += sD->stepSize;
+        sD->succesfulSteps++;
+
+        double orderParameter = 0;
+        if (sD->orderParameterCalculationIsOn)
+        {
+            orderParameter = calculateOrderParameter(lastSpeed);
+        }
+
+        // The speeds of the step belong to the dislocations before the annihilation
+        if (sD->isAnnihilation)
+        {
+            annihilateDislocations();
+        }
+
+        double current_wall_time = get_wall_time();
+
+        sD->currentStressStateType = Original;
+        if (SpringProtocol * spring = getSpringProtocol()) {
+            spring->calculateStress(sD->simTime, sD->dislocations, Original, sD->totalAccumulatedStrainIncrease);
+        } else {
+            sD->externalStressProtocol->calculateStress(sD->simTime, sD->dislocations, Original);
+        }
+        calculateSpeeds(sD->dislocations, sD->initSpeed);
+        initSpeedCalculationIsNeeded = false;
+        sD->sumAvgSpeed = std::accumulate(sD->initSpeed.begin(), sD->initSpeed.end(), 0.0, [](double a, double b){return a + fabs(b);}) / double(sD->dc);
+
+        if (sD->sumAvgSpeed < sD->speedLimit && sD->isSpeedLimit) {
+            sD->finish = true;
         }
 
         vsquare = std::accumulate(sD->initSpeed.begin(), sD->initSpeed.end(), 0.0, [](double a, double b){return a + b*b;});
@@ -569,36 +1802,69 @@ void Simulation::stepStageIII()
             }
         }
 
-        energyAccum += (vsquare2+vsquare)* 0.5 * sD->stepSize * 0.5;
-        sD->standardOutputLog <<
-                                 sD->simTime << " " <<
-                                 sD->succesfulSteps << " " <<
-                                 sD->failedSteps << " " <<
-                                 pH->getMaxErrorRatioSqr() << " " <<
-                                 sD->sumAvgSpeed << " " <<
-                                 sD->cutOff << " ";
+        energyAccum += (lastVSquare+vsquare)* 0.5 * lastInterval;
+        energy += energyAccum;
 
-        if (sD->orderParameterCalculationIsOn)
+        double row[] = {sD->simTime, double(sD->succesfulSteps), double(sD->failedSteps), pH->getMaxErrorRatioSqr(),
+                        sD->sumAvgSpeed, sD->cutOff, sD->orderParameterCalculationIsOn ? orderParameter : NAN,
+                        sD->externalStressProtocol->getStress(Original), current_wall_time - lastWriteTimeFinished,
+                        sD->calculateStrainDuringSimulation ? sD->totalAccumulatedStrainIncrease : NAN,
+                        vsquare, energy, double(newtonIterations)};
+        const double * selected = logAggregator ? logAggregator->addStep(row, sD->succesfulSteps, sD->simTime, sD->sumAvgSpeed) : row;
+        if (selected == nullptr)
         {
-            sD->standardOutputLog << orderParameter;
+            // The step is not logged
         }
-        else
+        else if (logAggregator && logAggregator->isWindowed())
         {
-            sD->standardOutputLog << "-";
+            writeAggregatedLogRow(selected);
         }
-
-
-        sD->standardOutputLog << " " << sD->externalStressProtocol->getStress(Original) << " " << current_wall_time - lastWriteTimeFinished;
-
-
-        if (sD->calculateStrainDuringSimulation)
+        else if (sD->binaryLog)
         {
-            sD->standardOutputLog << " " << sD->totalAccumulatedStrainIncrease;
+            sD->binaryLog->addRow(row);
         }
         else
         {
-            sD->standardOutputLog << " -";
+            sD->standardOutputLog <<
+                                     sD->simTime << " " <<
+                                     sD->succesfulSteps << " " <<
+                                     sD->failedSteps << " " <<
+                                     pH->getMaxErrorRatioSqr() << " " <<
+                                     sD->sumAvgSpeed << " " <<
+                                     sD->cutOff << " ";
+
+            if (sD->orderParameterCalculationIsOn)
+            {
+                sD->standardOutputLog << orderParameter;
+            }
+            else
+            {
+                sD->standardOutputLog << "-";
+            }
+
+
+            sD->standardOutputLog << " " << sD->externalStressProtocol->getStress(Original) << " " << current_wall_time - lastWriteTimeFinished;
+
+
+            if (sD->calculateStrainDuringSimulation)
+            {
+                sD->standardOutputLog << " " << sD->totalAccumulatedStrainIncrease;
+            }
+            else
+            {
+                sD->standardOutputLog << " -";
+            }
+
+            sD->standardOutputLog << " " << vsquare << " " << energy;
+
+            if (sD->isNewtonConvergenceControlled)
+            {
+                sD->standardOutputLog << " " << newtonIterations;
+            }
+
+            sD->standardOutputLog << "\n";
         }
+        newtonIterations = 0;
 
         if (sD->isStressLimit && sD->externalStressProtocol->getStress(Original) > sD->stressLimit ) {
             sD->finish = true;
@@ -610,21 +1876,16 @@ void Simulation::stepStageIII()
             sD->updateCutOff();
         }
 
-        energy += energyAccum;
-
-        sD->standardOutputLog << " " << vsquare << " " << energy;
-
-        sD->standardOutputLog << "\n";
-
         if (sD->isSaveSubConfigs)
         {
             if ((!sD->inAvalanche && sD->subConfigDelay >= sD->subconfigDistanceCounter) || (sD->inAvalanche && sD->subConfigDelayDuringAvalanche >= sD->subconfigDistanceCounter))
             {
                 sD->subconfigDistanceCounter = 0;
-                std::stringstream ss;
-                ss << std::setprecision(16);
-                ss << sD->simTime;
-                sD->writeDislocationDataToFile(sD->subConfigPath + "/" + ss.str() + ".dconf");
+                // Same format as a stream with 16 digit precision
+                char name[32];
+                snprintf(name, sizeof(name), "/%.16g.dconf", sD->simTime);
+                subConfigFileName.assign(sD->subConfigPath).append(name);
+                subConfigWriter.push(subConfigFileName, sD->simTime, sD->dislocations);
             }
             else
             {
@@ -640,13 +1901,40 @@ void Simulation::stepStageIII()
         sD->failedSteps++;
     }
 
-    sD->stepSize = pH->getNewStepSize(sD->stepSize);
+    double oldStepSize = sD->stepSize;
+    sD->stepSize = sD->stepSizeController->getNewStepSize(sD->stepSize, pH->getMaxErrorRatioSqr(), succesfulStep);
     pH->reset();
 
+    // The error estimate of a non converged step is meaningless, the step size is simply halved
+    if (newtonFailed)
+    {
+        sD->stepSize = 0.5 * oldStepSize;
+    }
+
+    // The step size is snapped to the half only if there is a half step to reuse (not with the other integrators)
+    if (!succesfulStep && sD->reuseHalfStep && halfway && !firstSmallStepFailed && sD->stepSize >= 0.5 * oldStepSize)
+    {
+        sD->stepSize = 0.5 * oldStepSize;
+    }
+
     if (sD->isMaxStepSizeLimit && sD->maxStepSizeLimit < sD->stepSize)
     {
         sD->stepSize = sD->maxStepSizeLimit;
     }
+
+    sD->bigStepWorkspace.tolerance.reset();
+    if (!succesfulStep && sD->reuseHalfStep && halfway && !firstSmallStepFailed && sD->stepSize == 0.5 * oldStepSize)
+    {
+        // The next big step is the first small step of this one, its tolerances are kept as well
+        bigStepIsReady = true;
+        sD->bigStep.swap(sD->firstSmall);
+        std::swap(sD->bigStepStrainIncrement, sD->firstSmallStrainIncrement);
+        std::swap(sD->bigStepWorkspace.tolerance, sD->smallStepWorkspace.tolerance);
+    }
+    else
+    {
+        sD->smallStepWorkspace.tolerance.reset();
+    }
 }
 
 const std::vector<Dislocation> &Simulation::getStoredDislocationData()
@@ -654,6 +1942,109 @@ const std::vector<Dislocation> &Simulation::getStoredDislocationData()
     return sD->dislocations;
 }
 
+SubConfigurationWriter &Simulation::getSubConfigurationWriter()
+{
+    return subConfigWriter;
+}
+
+void Simulation::writeCheckpoint(const std::string &path)
+{
+    // Everything written before the checkpoint has to be on the disk
+    subConfigWriter.flush();
+    int64_t logSize = -1;
+    if (sD->binaryLog)
+    {
+        logSize = sD->binaryLog->getSize();
+    }
+    else if (sD->standardOutputLog.is_open())
+    {
+        sD->standardOutputLog.flush();
+        logSize = int64_t(sD->standardOutputLog.tellp());
+    }
+    int64_t trajectorySize = sD->trajectoryPath.empty() ? -1 : getOutputFileSize(sD->trajectoryPath);
+
+    CheckpointWriter writer(path);
+    writer.write(logSize);
+    writer.write(trajectorySize);
+
+    sD->writeCheckpoint(writer);
+
+    std::vector<unsigned int> pairs;
+    for (const auto & p: boundPairs)
+    {
+        pairs.push_back(p.first);
+        pairs.push_back(p.second);
+    }
+
+    writer.write(succesfulStep);
+    writer.write(initSpeedCalculationIsNeeded);
+    writer.write(firstStepRequest);
+    writer.write(energy);
+    writer.write(vsquare);
+    writer.write(newtonIterations);
+    writer.write(lastInitSpeed);
+    writer.write(lastStepSize);
+    writer.write(pairs);
+    writer.write(bool(logAggregator));
+    if (logAggregator)
+    {
+        logAggregator->writeCheckpoint(writer);
+    }
+    writer.commit();
+}
+
+void Simulation::readCheckpoint(const std::string &path)
+{
+    CheckpointReader reader(path);
+
+    // The output written after the checkpoint is dropped by the parser before the files are opened
+    int64_t logSize;
+    int64_t trajectorySize;
+    reader.read(logSize);
+    reader.read(trajectorySize);
+
+    sD->readCheckpoint(reader);
+    // The stress protocol can be replaced, so the speculative trials are created again
+    trials.clear();
+
+    std::vector<unsigned int> pairs;
+    reader.read(succesfulStep);
+    reader.read(initSpeedCalculationIsNeeded);
+    reader.read(firstStepRequest);
+    reader.read(energy);
+    reader.read(vsquare);
+    reader.read(newtonIterations);
+    reader.read(lastInitSpeed);
+    reader.read(lastStepSize);
+    reader.read(pairs);
+    bool hasLogAggregator;
+    reader.read(hasLogAggregator);
+    if (hasLogAggregator != bool(logAggregator))
+    {
+        std::cerr << "The log selection of the checkpoint is different!\n";
+        exit(-1);
+    }
+    if (logAggregator)
+    {
+        logAggregator->readCheckpoint(reader);
+    }
+
+    boundPairs.clear();
+    for (size_t i = 0; i + 1 < pairs.size(); i += 2)
+    {
+        boundPairs.push_back(std::make_pair(pairs[i], pairs[i + 1]));
+    }
+
+    // The dislocation count can be different from the initial one because of the annihilations
+    pH->setSize(sD->dc);
+    pH->reset();
+    sD->bigStepWorkspace.tolerance.setSize(sD->dc);
+    sD->bigStepWorkspace.tolerance.reset();
+    sD->smallStepWorkspace.tolerance.setSize(sD->dc);
+    sD->smallStepWorkspace.tolerance.reset();
+    lastWriteTimeFinished = get_wall_time();
+}
+
 #ifdef BUILD_PYTHON_BINDINGS
 Simulation *Simulation::create(boost::python::object simulationData)
 {
@@ -18,7 +18,9 @@
  */
 
 #include "simulation_data.h"
+#include "configuration_file.h"
 #include "constants.h"
+#include "input_stream.h"
 #include "StressProtocols/stress_protocol.h"
 
 
@@ -49,19 +51,41 @@ SimulationData::SimulationData():
     pc(0),
     dc(0),
     ic(DEFAULT_ITERATION_COUNT),
+    isNewtonConvergenceControlled(false),
+    newtonTolerance(0),
+    minIterationCount(DEFAULT_MIN_ITERATION_COUNT),
+    maxIterationCount(DEFAULT_MAX_ITERATION_COUNT),
+    predictorOrder(0),
+    integrator(TrapezoidalStepDoubling),
+    richardsonExtrapolation(false),
     timeLimit(DEFAULT_TIME_LIMIT),
     stepSize(DEFAULT_STEP_SIZE),
     simTime(DEFAULT_SIM_TIME),
     KASQR(DEFAULT_KASQR),
     A(DEFAULT_A),
     tau(nullptr),
-    Ap(nullptr),
-    Ai(nullptr),
-    Ax(nullptr),
-    x(nullptr),
-    null(NULL),
-    Symbolic(nullptr),
-    Numeric(nullptr),
+    concurrentStages(false),
+    reuseHalfStep(false),
+    reusedHalfSteps(0),
+    multirateMaxSubsteps(0),
+    multirateMaxFastRatio(DEFAULT_MULTIRATE_MAX_FAST_RATIO),
+    multirateSteps(0),
+    isDipoleTreatment(false),
+    dipoleDistance(0),
+    speculativeTrials(0),
+    relaxationForceTolerance(DEFAULT_RELAXATION_FORCE_TOLERANCE),
+    relaxationMaxIterations(DEFAULT_RELAXATION_MAX_ITERATIONS),
+    aqsStressStep(DEFAULT_AQS_STRESS_STEP),
+    aqsAvalancheStrain(DEFAULT_AQS_AVALANCHE_STRAIN),
+    bigStepStrainIncrement(0),
+    firstSmallStrainIncrement(0),
+    secondSmallStrainIncrement(0),
+    dipoleBindings(0),
+    dipoleReleases(0),
+    isAnnihilation(false),
+    annihilationDistance(0),
+    annihilations(0),
+    stepHeapAllocations(0),
     succesfulSteps(0),
     failedSteps(0),
     totalAccumulatedStrainIncrease(0),
@@ -80,8 +104,13 @@ SimulationData::SimulationData():
     calculateStrainDuringSimulation(false),
     orderParameterCalculationIsOn(false),
     standardOutputLog(),
+    binaryLog(),
+    logStepInterval(0),
+    logTimeWindow(0),
+    logFullDuringAvalanche(false),
     endDislocationConfigurationPath(""),
     externalStressProtocol(nullptr),
+    stepSizeController(new StepSizeController),
     countAvalanches(false),
     avalancheSpeedThreshold(0),
     avalancheTriggerLimit(0),
@@ -89,13 +118,22 @@ SimulationData::SimulationData():
     inAvalanche(false),
     isSaveSubConfigs(false),
     subConfigPath(""),
+    trajectoryPath(""),
+    trajectoryChunkSize(DEFAULT_TRAJECTORY_CHUNK_SIZE),
+    compressTrajectory(false),
+    deltaEncodeTrajectory(false),
+    checkpointPath(""),
+    checkpointInterval(0),
+    restartPath(""),
     subConfigDelay(0),
     subConfigDelayDuringAvalanche(0),
     subconfigDistanceCounter(0),
+    subConfigQueueSize(DEFAULT_SUB_CONFIG_QUEUE_SIZE),
+    subConfigQueueMaxDepth(0),
+    subConfigBlockedTime(0),
     currentStressStateType(sdddstCore::StressProtocolStepType::Original),
     speedThresholdForCutoffChange(0),
     isSpeedThresholdForCutoffChange(false),
-    currentStorageSize(0),
     sumAvgSpeed(0),
     eVAnalResultFile(""),
     remainingFinalSteps(0),
@@ -126,8 +164,26 @@ void SimulationData::readDislocationDataFromFile(const std::string &dislocationD
     dislocations.resize(0);
     dislocationDataIsLoaded = true;
 
-    std::ifstream in(dislocationDataFilePath);
-    assert(in.is_open() && "Cannot open dislocation data file!");
+    if (isBinaryConfigurationFile(dislocationDataFilePath))
+    {
+        MappedConfigurationFile file(dislocationDataFilePath, DislocationConfiguration);
+        const double * x = file.getColumn(0);
+        const double * y = file.getColumn(1);
+        const double * b = file.getColumn(2);
+        dc = file.getCount();
+        dislocations.resize(dc);
+        for (unsigned int i = 0; i < dc; i++)
+        {
+            dislocations[i].x = x[i];
+            dislocations[i].y = y[i];
+            dislocations[i].b = b[i];
+        }
+        updateMemoryUsageAccordingToDislocationCount();
+        return;
+    }
+
+    InputStream input(dislocationDataFilePath);
+    std::istream & in = input.get();
 
     // Iterating through the file
     dc = 0;
@@ -146,10 +202,20 @@ void SimulationData::readDislocationDataFromFile(const std::string &dislocationD
         dislocations.push_back(tmp);
         dc++;
     }
+    if (in.bad())
+    {
+        std::cerr << "Cannot read " << dislocationDataFilePath << std::endl;
+        exit(-1);
+    }
     updateMemoryUsageAccordingToDislocationCount();
 }
 
 void SimulationData::writeDislocationDataToFile(const std::string &dislocationDataFilePath)
+{
+    writeDislocationsToFile(dislocationDataFilePath, dislocations);
+}
+
+void SimulationData::writeDislocationsToFile(const std::string &dislocationDataFilePath, const std::vector<Dislocation> &dislocations)
 {
     std::ofstream out(dislocationDataFilePath);
     assert(out.is_open() && "Cannot open the data file to write!");
@@ -160,6 +226,14 @@ void SimulationData::writeDislocationDataToFile(const std::string &dislocationDa
     }
 }
 
+void SimulationData::readDislocationDataFromTrajectory(TrajectoryReader &trajectory, size_t frame)
+{
+    dislocationDataIsLoaded = true;
+    trajectory.readFrame(frame, dislocations);
+    dc = dislocations.size();
+    updateMemoryUsageAccordingToDislocationCount();
+}
+
 void SimulationData::readPointDefectDataFromFile(const std::string &pointDefectDataFilePath)
 {
     if (pointDefectDataFilePath.empty())
@@ -169,8 +243,24 @@ void SimulationData::readPointDefectDataFromFile(const std::string &pointDefectD
     }
     pc = 0;
     points.resize(0);
-    std::ifstream in(pointDefectDataFilePath);
-    assert(in.is_open() && "Cannot open fixpoints data file!");
+
+    if (isBinaryConfigurationFile(pointDefectDataFilePath))
+    {
+        MappedConfigurationFile file(pointDefectDataFilePath, PointDefectConfiguration);
+        const double * x = file.getColumn(0);
+        const double * y = file.getColumn(1);
+        pc = file.getCount();
+        points.resize(pc);
+        for (unsigned int i = 0; i < pc; i++)
+        {
+            points[i].x = x[i];
+            points[i].y = y[i];
+        }
+        return;
+    }
+
+    InputStream input(pointDefectDataFilePath);
+    std::istream & in = input.get();
 
     // Iterating through the file
     while (!in.eof())
@@ -187,6 +277,11 @@ void SimulationData::readPointDefectDataFromFile(const std::string &pointDefectD
         points.push_back(tmp);
         pc++;
     }
+    if (in.bad())
+    {
+        std::cerr << "Cannot read " << pointDefectDataFilePath << std::endl;
+        exit(-1);
+    }
 }
 
 void SimulationData::writePointDefectDataToFile(const std::string &pointDefectDataFilePath)
@@ -217,8 +312,157 @@ void SimulationData::updateCutOff()
     onePerCutOffSqr = 1./cutOffSqr;
 }
 
+void SimulationData::copyRunConstants(const SimulationData &other)
+{
+    points = other.points;
+    pc = other.pc;
+    externalStressProtocol = other.externalStressProtocol->clone();
+}
+
+void SimulationData::copyStepState(const SimulationData &other)
+{
+    if (dc != other.dc)
+    {
+        dc = other.dc;
+        updateMemoryUsageAccordingToDislocationCount();
+    }
+    dislocations = other.dislocations;
+    initSpeed = other.initSpeed;
+    initSpeed2 = other.initSpeed2;
+
+    cutOffMultiplier = other.cutOffMultiplier;
+    cutOff = other.cutOff;
+    cutOffSqr = other.cutOffSqr;
+    onePerCutOffSqr = other.onePerCutOffSqr;
+    prec = other.prec;
+    ic = other.ic;
+    isNewtonConvergenceControlled = other.isNewtonConvergenceControlled;
+    newtonTolerance = other.newtonTolerance;
+    minIterationCount = other.minIterationCount;
+    maxIterationCount = other.maxIterationCount;
+    predictorOrder = other.predictorOrder;
+    integrator = other.integrator;
+    richardsonExtrapolation = other.richardsonExtrapolation;
+    stepSize = other.stepSize;
+    simTime = other.simTime;
+    KASQR = other.KASQR;
+    A = other.A;
+    multirateMaxSubsteps = other.multirateMaxSubsteps;
+    multirateMaxFastRatio = other.multirateMaxFastRatio;
+    isDipoleTreatment = other.isDipoleTreatment;
+    dipoleDistance = other.dipoleDistance;
+    totalAccumulatedStrainIncrease = other.totalAccumulatedStrainIncrease;
+    calculateStrainDuringSimulation = other.calculateStrainDuringSimulation;
+    currentStressStateType = other.currentStressStateType;
+
+    tau = other.tau;
+    externalStressProtocol->copyState(*other.externalStressProtocol);
+
+    bigStepWorkspace.tolerance = other.bigStepWorkspace.tolerance;
+    smallStepWorkspace.tolerance = other.smallStepWorkspace.tolerance;
+    bigStepWorkspace.iterationCount = 0;
+    smallStepWorkspace.iterationCount = 0;
+    bigStepWorkspace.newtonFailed = false;
+    smallStepWorkspace.newtonFailed = false;
+}
+
+void SimulationData::writeCheckpoint(CheckpointWriter &writer) const
+{
+    writer.write(pc);
+    writer.write(dislocations);
+    writer.write(initSpeed);
+    writer.write(initSpeed2);
+
+    writer.write(simTime);
+    writer.write(stepSize);
+    writer.write(cutOffMultiplier);
+    writer.write(A);
+    writer.write(KASQR);
+    writer.write(currentStressStateType);
+
+    writer.write(succesfulSteps);
+    writer.write(failedSteps);
+    writer.write(totalAccumulatedStrainIncrease);
+    writer.write(reusedHalfSteps);
+    writer.write(multirateSteps);
+    writer.write(dipoleBindings);
+    writer.write(dipoleReleases);
+    writer.write(annihilations);
+
+    writer.write(avalancheCount);
+    writer.write(inAvalanche);
+    writer.write(subconfigDistanceCounter);
+    writer.write(sumAvgSpeed);
+    writer.write(remainingFinalSteps);
+    writer.write(inFinal);
+    writer.write(finish);
+
+    writer.write(externalStressProtocol->getType());
+    externalStressProtocol->writeCheckpoint(writer);
+    writer.write(stepSizeController->getType());
+    stepSizeController->writeCheckpoint(writer);
+}
+
+void SimulationData::readCheckpoint(CheckpointReader &reader)
+{
+    unsigned int storedPointCount;
+    reader.read(storedPointCount);
+    if (storedPointCount != pc)
+    {
+        std::cerr << "The checkpoint was written with " << storedPointCount << " point defects instead of " << pc << "!\n";
+        exit(-1);
+    }
+
+    dislocationDataIsLoaded = true;
+    reader.read(dislocations);
+    dc = dislocations.size();
+    updateMemoryUsageAccordingToDislocationCount();
+    reader.read(initSpeed);
+    reader.read(initSpeed2);
+
+    reader.read(simTime);
+    reader.read(stepSize);
+    reader.read(cutOffMultiplier);
+    updateCutOff();
+    reader.read(A);
+    reader.read(KASQR);
+    reader.read(currentStressStateType);
+
+    reader.read(succesfulSteps);
+    reader.read(failedSteps);
+    reader.read(totalAccumulatedStrainIncrease);
+    reader.read(reusedHalfSteps);
+    reader.read(multirateSteps);
+    reader.read(dipoleBindings);
+    reader.read(dipoleReleases);
+    reader.read(annihilations);
+
+    reader.read(avalancheCount);
+    reader.read(inAvalanche);
+    reader.read(subconfigDistanceCounter);
+    reader.read(sumAvgSpeed);
+    reader.read(remainingFinalSteps);
+    reader.read(inFinal);
+    reader.read(finish);
+
+    reader.expect(externalStressProtocol->getType());
+    externalStressProtocol->readCheckpoint(reader);
+    reader.expect(stepSizeController->getType());
+    stepSizeController->readCheckpoint(reader);
+}
+
 #ifdef BUILD_PYTHON_BINDINGS
 
+std::vector<double> &SimulationData::getG()
+{
+    return bigStepWorkspace.g;
+}
+
+std::vector<double> &SimulationData::getDVec()
+{
+    return bigStepWorkspace.dVec;
+}
+
 Field const &SimulationData::getField()
 {
     return *tau;
@@ -250,49 +494,53 @@ void SimulationData::setStressProtocol(boost::python::object protocol)
 }
 #endif
 
+void SimulationData::removeDislocations(const std::vector<unsigned int> & IDs)
+{
+    size_t next = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < dc; i++)
+    {
+        if (next < IDs.size() && IDs[next] == i)
+        {
+            next++;
+            continue;
+        }
+        dislocations[kept++] = dislocations[i];
+    }
+    dc = kept;
+    dislocations.resize(dc);
+    initSpeed.resize(dc);
+    initSpeed2.resize(dc);
+    bigStep.resize(dc);
+    firstSmall.resize(dc);
+    secondSmall.resize(dc);
+    bigStepWorkspace.shrink(dc);
+    smallStepWorkspace.shrink(dc);
+
+    // The cutoff depends on the dislocation count
+    updateCutOff();
+}
+
 void SimulationData::deleteDislocationCountRelatedData()
 {
     dc = 0;
     dislocations.resize(0);
-    g.resize(0);
     initSpeed.resize(0);
     initSpeed2.resize(0);
-    speed.resize(0);
-    speed2.resize(0);
-    dVec.resize(0);
     bigStep.resize(0);
     firstSmall.resize(0);
     secondSmall.resize(0);
-    free(Ap);
-    Ap = nullptr;
-    free(Ai);
-    Ai = nullptr;
-    free(Ax);
-    Ax = nullptr;
-    free(x);
-    x = nullptr;
-    indexes.resize(0);
+    bigStepWorkspace.release();
+    smallStepWorkspace.release();
 }
 
 void SimulationData::updateMemoryUsageAccordingToDislocationCount()
 {
-    currentStorageSize = dc;
-    g.resize(dc);
     initSpeed.resize(dc);
     initSpeed2.resize(dc);
-    speed.resize(dc);
-    speed2.resize(dc);
-    dVec.resize(dc);
     bigStep.resize(dc);
     firstSmall.resize(dc);
     secondSmall.resize(dc);
-    Ap = (int*) calloc(dc+1, sizeof(int));
-    Ai = (int*) calloc(dc*dc, sizeof(int));
-    Ax = (double*) calloc(dc, sizeof(double));
-    x = (double*) calloc(dc, sizeof(double));
-    assert(Ap && "Memory allication for Ap failed!");
-    assert(Ai && "Memory allocation for Ai failed!");
-    assert(Ax && "Memory allocation for Ax failed!");
-    assert(x && "Memory allocation for x failed!");
-    indexes.resize(dc);
+    bigStepWorkspace.resize(dc);
+    smallStepWorkspace.resize(dc);
 }
@@ -0,0 +1,146 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "sub_configuration_writer.h"
+#include "simulation_data.h"
+#include "utility.h"
+
+using namespace sdddstCore;
+
+SubConfigurationWriter::SubConfigurationWriter(unsigned int capacity):
+    slots(capacity > 0 ? capacity : 1),
+    head(0),
+    depth(0),
+    maxDepth(0),
+    blockedTime(0),
+    stop(false),
+    trajectoryChunkSize(0),
+    trajectoryEncoding(TrajectoryRaw),
+    trajectoryQuantisation(0),
+    trajectoryAppend(false)
+{
+
+}
+
+SubConfigurationWriter::~SubConfigurationWriter()
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    queued.notify_one();
+    if (writer.joinable())
+    {
+        writer.join();
+    }
+}
+
+void SubConfigurationWriter::setTrajectory(const std::string &path, unsigned int framesPerChunk, TrajectoryEncoding encoding, double quantisation, bool append)
+{
+    trajectoryPath = path;
+    trajectoryChunkSize = framesPerChunk;
+    trajectoryEncoding = encoding;
+    trajectoryQuantisation = quantisation;
+    trajectoryAppend = append;
+}
+
+void SubConfigurationWriter::push(const std::string &path, double time, const std::vector<Dislocation> &dislocations)
+{
+    if (!writer.joinable())
+    {
+        writer = std::thread(&SubConfigurationWriter::work, this);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (depth == slots.size())
+    {
+        double start = get_wall_time();
+        written.wait(lock, [this] { return depth < slots.size(); });
+        blockedTime += get_wall_time() - start;
+    }
+
+    // The slot is not used by the writer thread until depth is increased
+    Slot & slot = slots[(head + depth) % slots.size()];
+    slot.path.assign(path);
+    slot.time = time;
+    slot.dislocations.assign(dislocations.begin(), dislocations.end());
+    depth++;
+    if (depth > maxDepth)
+    {
+        maxDepth = depth;
+    }
+    lock.unlock();
+    queued.notify_one();
+}
+
+void SubConfigurationWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [this] { return depth == 0; });
+    // The writer thread is waiting for the next configuration, so the trajectory can be used here
+    if (trajectory)
+    {
+        trajectory->flush();
+    }
+}
+
+size_t SubConfigurationWriter::getMaxDepth() const
+{
+    return maxDepth;
+}
+
+double SubConfigurationWriter::getBlockedTime() const
+{
+    return blockedTime;
+}
+
+void SubConfigurationWriter::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        queued.wait(lock, [this] { return depth > 0 || stop; });
+        if (depth == 0)
+        {
+            return;
+        }
+
+        // The head slot is only released after it is written, so it can be used without the lock
+        Slot & slot = slots[head];
+        lock.unlock();
+        if (trajectoryPath.empty())
+        {
+            SimulationData::writeDislocationsToFile(slot.path, slot.dislocations);
+        }
+        else
+        {
+            if (!trajectory)
+            {
+                trajectory.reset(new TrajectoryWriter(trajectoryPath, trajectoryChunkSize, trajectoryEncoding, trajectoryQuantisation, trajectoryAppend));
+            }
+            trajectory->addFrame(slot.time, slot.dislocations);
+        }
+        lock.lock();
+
+        head = (head + 1) % slots.size();
+        depth--;
+        written.notify_all();
+    }
+}
@@ -0,0 +1,493 @@
+/*
+ * SDDDST Simple Discrete Dislocation Dynamics Toolkit
+ * Copyright (C) 2015-2019  Gábor Péterffy <peterffy95@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include "trajectory.h"
+#include "constants.h"
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace sdddstCore;
+
+namespace {
+
+void corrupted(const std::string & path)
+{
+    std::cerr << "Invalid or corrupted trajectory file " << path << std::endl;
+    exit(-1);
+}
+
+// The frames of a delta encoded chunk start with their type
+enum DeltaFrameType : char
+{
+    DeltaFullFrame = 0,
+    DeltaDifferenceFrame = 1
+};
+
+// A zig-zag varint of a 64 bit value takes at most 10 bytes
+const size_t VARINT_MAX_LENGTH = 10;
+
+// Larger quantised differences are not stored (2^53, the doubles are exact integers up to it), the frame is stored completely
+const double DELTA_MAX_STEPS = 9007199254740992.0;
+
+void appendDoubles(std::string & out, const double * data, size_t count)
+{
+    out.append(reinterpret_cast<const char*>(data), count * sizeof(double));
+}
+
+// Zig-zag mapping of the sign and base 128 variable length integers, small differences take one byte
+void appendVarint(std::string & out, int64_t value)
+{
+    uint64_t u = (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+    while (u >= 0x80)
+    {
+        out.push_back(char((u & 0x7f) | 0x80));
+        u >>= 7;
+    }
+    out.push_back(char(u));
+}
+
+bool readVarint(const std::string & in, size_t & pos, int64_t & value)
+{
+    uint64_t u = 0;
+    for (unsigned int shift = 0; shift < 64 && pos < in.size(); shift += 7)
+    {
+        unsigned char byte = static_cast<unsigned char>(in[pos++]);
+        u |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            value = int64_t(u >> 1) ^ -int64_t(u & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void zlibCompress(const std::string & in, std::string & out)
+{
+    out.clear();
+    boost::iostreams::filtering_ostream zip;
+    zip.push(boost::iostreams::zlib_compressor());
+    zip.push(boost::iostreams::back_inserter(out));
+    zip.write(in.data(), std::streamsize(in.size()));
+    zip.reset();
+}
+
+// Returns the number of decompressed bytes
+size_t zlibDecompress(const std::string & in, char * out, size_t size)
+{
+    boost::iostreams::filtering_istream unzip;
+    unzip.push(boost::iostreams::zlib_decompressor());
+    unzip.push(boost::iostreams::array_source(in.data(), in.size()));
+    unzip.read(out, std::streamsize(size));
+    return size_t(unzip.gcount());
+}
+
+}
+
+bool sdddstCore::isTrajectoryFile(const std::string &path)
+{
+    // Only a regular file can be a trajectory, a pipe is not read here
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        return false;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    char magic[8];
+    if (!in.read(magic, sizeof(magic)))
+    {
+        return false;
+    }
+    return memcmp(magic, TRAJECTORY_FILE_MAGIC, sizeof(magic)) == 0;
+}
+
+TrajectoryWriter::TrajectoryWriter(const std::string &path, unsigned int framesPerChunk, TrajectoryEncoding encoding, double quantisation, bool append):
+    framesPerChunk(framesPerChunk > 0 ? framesPerChunk : 1),
+    encoding(encoding),
+    quantisation(quantisation)
+{
+    // An empty file is started from the header even if it should be continued
+    std::ifstream existing(path, std::ios::binary | std::ios::ate);
+    append = append && existing.is_open() && existing.tellg() > 0;
+    existing.close();
+
+    if (append)
+    {
+        if (!isTrajectoryFile(path))
+        {
+            std::cerr << path << " exists and it is not a trajectory file!" << std::endl;
+            exit(-1);
+        }
+        // A chunk which was not finished by a previous run is dropped
+        TrajectoryReader reader(path);
+        if (truncate(path.c_str(), off_t(reader.getIndexedSize())) != 0)
+        {
+            std::cerr << "Cannot truncate trajectory file " << path << std::endl;
+            exit(-1);
+        }
+        out.open(path, std::ios::binary | std::ios::app);
+    }
+    else
+    {
+        out.open(path, std::ios::binary | std::ios::trunc);
+        TrajectoryFileHeader header;
+        memcpy(header.magic, TRAJECTORY_FILE_MAGIC, sizeof(header.magic));
+        header.version = TRAJECTORY_FILE_VERSION;
+        header.reserved = 0;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.flush();
+    }
+
+    if (!out.is_open())
+    {
+        std::cerr << "Cannot open " << path << " to write!" << std::endl;
+        exit(-1);
+    }
+
+    if (encoding == TrajectoryDelta && !(quantisation > 0))
+    {
+        std::cerr << "The quantisation of the delta encoded trajectory must be positive!" << std::endl;
+        exit(-1);
+    }
+}
+
+TrajectoryWriter::~TrajectoryWriter()
+{
+    flush();
+}
+
+void TrajectoryWriter::addFrame(double time, const std::vector<Dislocation> &dislocations)
+{
+    TrajectoryFrameIndex frame;
+    frame.time = time;
+    frame.count = dislocations.size();
+    frame.offset = payload.size() * sizeof(double);
+    frames.push_back(frame);
+
+    for (auto & d: dislocations)
+    {
+        payload.push_back(d.x);
+    }
+    for (auto & d: dislocations)
+    {
+        payload.push_back(d.y);
+    }
+    for (auto & d: dislocations)
+    {
+        payload.push_back(d.b);
+    }
+
+    if (frames.size() >= framesPerChunk)
+    {
+        flush();
+    }
+}
+
+void TrajectoryWriter::flush()
+{
+    if (frames.empty())
+    {
+        return;
+    }
+
+    TrajectoryChunkHeader header;
+    header.encoding = encoding;
+    header.frameCount = uint32_t(frames.size());
+    header.rawSize = payload.size() * sizeof(double);
+
+    const char * stored = reinterpret_cast<const char*>(payload.data());
+    header.storedSize = header.rawSize;
+    if (encoding != TrajectoryRaw)
+    {
+        if (encoding == TrajectoryDelta)
+        {
+            deltaEncode();
+        }
+        else
+        {
+            encoded.assign(stored, header.rawSize);
+        }
+        zlibCompress(encoded, compressed);
+        stored = compressed.data();
+        header.storedSize = compressed.size();
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(frames.data()), std::streamsize(frames.size() * sizeof(TrajectoryFrameIndex)));
+    out.write(stored, std::streamsize(header.storedSize));
+    out.flush();
+
+    frames.clear();
+    payload.clear();
+}
+
+void TrajectoryWriter::deltaEncode()
+{
+    encoded.clear();
+    appendDoubles(encoded, &quantisation, 1);
+
+    const TrajectoryFrameIndex * previous = nullptr;
+    for (auto & frame: frames)
+    {
+        const double * x = payload.data() + frame.offset / sizeof(double);
+        const double * yb = x + frame.count;
+
+        // Only x changes while the dislocations are not removed
+        bool difference = previous != nullptr && previous->count == frame.count &&
+                std::equal(yb, yb + 2 * frame.count, payload.data() + previous->offset / sizeof(double) + previous->count);
+
+        // The quantised differences have to fit into the integers (a jump compared to the quantisation or a non finite value)
+        for (size_t i = 0; difference && i < frame.count; i++)
+        {
+            difference = std::fabs(x[i] - reconstructed[i]) / quantisation < DELTA_MAX_STEPS;
+        }
+
+        if (difference)
+        {
+            encoded.push_back(DeltaDifferenceFrame);
+            for (size_t i = 0; i < frame.count; i++)
+            {
+                // The difference is taken to the decoded value, so the errors do not accumulate
+                int64_t q = int64_t(std::llround((x[i] - reconstructed[i]) / quantisation));
+                appendVarint(encoded, q);
+                reconstructed[i] += double(q) * quantisation;
+            }
+        }
+        else
+        {
+            encoded.push_back(DeltaFullFrame);
+            appendDoubles(encoded, x, 3 * frame.count);
+            reconstructed.assign(x, x + frame.count);
+        }
+        previous = &frame;
+    }
+}
+
+TrajectoryReader::TrajectoryReader(const std::string &path):
+    path(path),
+    in(path, std::ios::binary),
+    indexedSize(sizeof(TrajectoryFileHeader)),
+    loadedChunk(std::numeric_limits<size_t>::max())
+{
+    TrajectoryFileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            memcmp(header.magic, TRAJECTORY_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != TRAJECTORY_FILE_VERSION)
+    {
+        corrupted(path);
+    }
+    update();
+}
+
+size_t TrajectoryReader::update()
+{
+    size_t oldFrameCount = frames.size();
+
+    in.clear();
+    in.seekg(0, std::ios::end);
+    uint64_t fileSize = uint64_t(in.tellg());
+
+    while (indexedSize + sizeof(TrajectoryChunkHeader) <= fileSize)
+    {
+        Chunk chunk;
+        chunk.firstFrame = frames.size();
+        in.seekg(std::streamoff(indexedSize));
+        in.read(reinterpret_cast<char*>(&chunk.header), sizeof(chunk.header));
+        chunk.payloadOffset = indexedSize + sizeof(TrajectoryChunkHeader) + chunk.header.frameCount * sizeof(TrajectoryFrameIndex);
+        uint64_t end = chunk.payloadOffset + chunk.header.storedSize;
+        if (!in || end > fileSize)
+        {
+            // The chunk is still being written
+            break;
+        }
+
+        if (chunk.header.encoding > TrajectoryDelta || chunk.header.rawSize % sizeof(double) != 0)
+        {
+            corrupted(path);
+        }
+
+        for (uint32_t i = 0; i < chunk.header.frameCount; i++)
+        {
+            Frame frame;
+            frame.chunk = chunks.size();
+            in.read(reinterpret_cast<char*>(&frame.index), sizeof(frame.index));
+            if (frame.index.offset + 3 * frame.index.count * sizeof(double) > chunk.header.rawSize)
+            {
+                corrupted(path);
+            }
+            frames.push_back(frame);
+        }
+        chunks.push_back(chunk);
+        indexedSize = end;
+    }
+
+    return frames.size() - oldFrameCount;
+}
+
+size_t TrajectoryReader::getFrameCount() const
+{
+    return frames.size();
+}
+
+double TrajectoryReader::getTime(size_t frame) const
+{
+    return frames.at(frame).index.time;
+}
+
+uint64_t TrajectoryReader::getIndexedSize() const
+{
+    return indexedSize;
+}
+
+void TrajectoryReader::readFrame(size_t frame, std::vector<Dislocation> &dislocations)
+{
+    const TrajectoryFrameIndex & index = frames.at(frame).index;
+    loadChunk(frames[frame].chunk);
+
+    const double * x = payload.data() + index.offset / sizeof(double);
+    const double * y = x + index.count;
+    const double * b = y + index.count;
+    dislocations.resize(index.count);
+    for (size_t i = 0; i < index.count; i++)
+    {
+        dislocations[i].x = x[i];
+        dislocations[i].y = y[i];
+        dislocations[i].b = b[i];
+    }
+}
+
+void TrajectoryReader::loadChunk(size_t chunk)
+{
+    if (chunk == loadedChunk)
+    {
+        return;
+    }
+
+    const TrajectoryChunkHeader & header = chunks[chunk].header;
+    payload.resize(header.rawSize / sizeof(double));
+    in.clear();
+    in.seekg(std::streamoff(chunks[chunk].payloadOffset));
+
+    if (header.encoding == TrajectoryRaw)
+    {
+        in.read(reinterpret_cast<char*>(payload.data()), std::streamsize(header.rawSize));
+    }
+    else
+    {
+        stored.resize(header.storedSize);
+        in.read(&stored[0], std::streamsize(header.storedSize));
+        if (header.encoding == TrajectoryZlib)
+        {
+            if (zlibDecompress(stored, reinterpret_cast<char*>(payload.data()), header.rawSize) != header.rawSize)
+            {
+                corrupted(path);
+            }
+        }
+        else
+        {
+            // The longest encoding of every frame fits (the extra byte reveals a longer, corrupted chunk)
+            size_t maxSize = sizeof(double);
+            for (size_t f = chunks[chunk].firstFrame; f < chunks[chunk].firstFrame + header.frameCount; f++)
+            {
+                size_t count = frames[f].index.count;
+                maxSize += 1 + std::max(3 * count * sizeof(double), count * VARINT_MAX_LENGTH);
+            }
+            decompressed.resize(maxSize + 1);
+            decompressed.resize(zlibDecompress(stored, &decompressed[0], decompressed.size()));
+            if (decompressed.size() > maxSize)
+            {
+                corrupted(path);
+            }
+            deltaDecode(chunk);
+        }
+    }
+
+    if (!in)
+    {
+        corrupted(path);
+    }
+    loadedChunk = chunk;
+}
+
+void TrajectoryReader::deltaDecode(size_t chunk)
+{
+    size_t pos = sizeof(double);
+    double quantisation;
+    if (decompressed.size() < pos)
+    {
+        corrupted(path);
+    }
+    memcpy(&quantisation, decompressed.data(), sizeof(double));
+
+    const TrajectoryFrameIndex * previous = nullptr;
+    for (size_t f = chunks[chunk].firstFrame; f < chunks[chunk].firstFrame + chunks[chunk].header.frameCount; f++)
+    {
+        const TrajectoryFrameIndex & frame = frames[f].index;
+        double * x = payload.data() + frame.offset / sizeof(double);
+
+        if (pos >= decompressed.size())
+        {
+            corrupted(path);
+        }
+        char type = decompressed[pos++];
+        if (type == DeltaDifferenceFrame)
+        {
+            if (previous == nullptr || previous->count != frame.count)
+            {
+                corrupted(path);
+            }
+            const double * previousX = payload.data() + previous->offset / sizeof(double);
+            for (size_t i = 0; i < frame.count; i++)
+            {
+                int64_t q;
+                if (!readVarint(decompressed, pos, q))
+                {
+                    corrupted(path);
+                }
+                x[i] = previousX[i] + double(q) * quantisation;
+            }
+            std::copy(previousX + frame.count, previousX + 3 * frame.count, x + frame.count);
+        }
+        else
+        {
+            size_t size = 3 * frame.count * sizeof(double);
+            if (pos + size > decompressed.size())
+            {
+                corrupted(path);
+            }
+            memcpy(x, decompressed.data() + pos, size);
+            pos += size;
+        }
+        previous = &frame;
+    }
+}